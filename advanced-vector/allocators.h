@@ -0,0 +1,568 @@
+#pragma once
+
+/**
+ * @file allocators.h
+ * @brief Allocators for the Vector class that offer more than the general-purpose heap.
+ */
+
+#include <algorithm>
+#include <bit>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+
+#if defined(__linux__)
+#include <linux/mempolicy.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+/**
+ * @brief The MallocAllocator class allocates memory with malloc and can grow blocks with realloc.
+ * RawMemory uses reallocate() to grow buffers of trivially relocatable elements in place.
+ * glibc serves large blocks with mmap and grows them with mremap, so a huge buffer is neither
+ * copied nor transiently allocated twice.
+ */
+template <typename T>
+class MallocAllocator {
+    static_assert(alignof(T) <= alignof(std::max_align_t), "malloc does not guarantee over-aligned storage");
+
+    public:
+        using value_type = T;
+        using is_always_equal = std::true_type;
+
+        MallocAllocator() = default;
+
+        template <typename U>
+        MallocAllocator(const MallocAllocator<U>&) noexcept {}
+
+        /**
+         * @brief Allocates memory for the specified number of elements.
+         * @param n The number of elements.
+         * @return A pointer to the allocated memory block.
+         */
+        T* allocate(size_t n) {
+            return Check(std::malloc(n * sizeof(T)));
+        }
+
+        /**
+         * @brief Deallocates the memory block.
+         * @param p The pointer to the memory block.
+         */
+        void deallocate(T* p, size_t) noexcept {
+            std::free(p);
+        }
+
+        /**
+         * @brief Resizes the memory block, extending it in place when possible.
+         * The content is preserved bytewise, on failure the original block is left untouched.
+         * @param p The pointer to the memory block, may be nullptr.
+         * @param new_n The new number of elements.
+         * @return A pointer to the resized memory block.
+         */
+        T* reallocate(T* p, size_t /*old_n*/, size_t new_n) {
+            return Check(std::realloc(static_cast<void*>(p), new_n * sizeof(T)));
+        }
+
+        friend bool operator==(const MallocAllocator&, const MallocAllocator&) noexcept {
+            return true;
+        }
+
+    private:
+        static T* Check(void* p) {
+            if (p == nullptr) {
+                throw std::bad_alloc();
+            }
+            return static_cast<T*>(p);
+        }
+};
+
+/**
+ * @brief The AlignedAllocator class allocates memory aligned to Alignment bytes with the aligned operator new.
+ * It declares a capacity_granularity of one alignment unit, so RawMemory pads the capacity to a whole
+ * number of vector registers and SIMD kernels can process the tail without a scalar remainder loop.
+ * @tparam Alignment The alignment in bytes, a power of two not less than alignof(T). 64 matches AVX-512 and cache lines.
+ */
+template <typename T, size_t Alignment = 64>
+class AlignedAllocator {
+    static_assert(Alignment >= alignof(T) && (Alignment & (Alignment - 1)) == 0, "Alignment must be a power of two not less than alignof(T)");
+
+    public:
+        using value_type = T;
+        using is_always_equal = std::true_type;
+
+        template <typename U>
+        struct rebind {
+            using other = AlignedAllocator<U, Alignment>;
+        };
+
+        /*< The number of elements the capacity is rounded up to. */
+        static constexpr size_t capacity_granularity = Alignment % sizeof(T) == 0 ? Alignment / sizeof(T) : 1;
+
+        AlignedAllocator() = default;
+
+        template <typename U>
+        AlignedAllocator(const AlignedAllocator<U, Alignment>&) noexcept {}
+
+        /**
+         * @brief Allocates aligned memory for the specified number of elements.
+         * @param n The number of elements.
+         * @return A pointer to the allocated memory block.
+         */
+        T* allocate(size_t n) {
+            return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t{Alignment}));
+        }
+
+        /**
+         * @brief Deallocates the memory block.
+         * @param p The pointer to the memory block.
+         * @param n The number of elements the block was allocated for.
+         */
+        void deallocate(T* p, size_t n) noexcept {
+            ::operator delete(p, n * sizeof(T), std::align_val_t{Alignment});
+        }
+
+        friend bool operator==(const AlignedAllocator&, const AlignedAllocator&) noexcept {
+            return true;
+        }
+};
+
+/**
+ * @brief The limits of the blocks a ThreadBlockPool keeps for reuse.
+ */
+struct PoolLimits {
+    size_t max_cached_bytes = size_t(4) << 20;  /*< The total size of the cached blocks, larger frees go to the heap. */
+    size_t max_block_bytes = size_t(256) << 10; /*< The largest block size class that is cached. */
+};
+
+/**
+ * @brief The counters of a ThreadBlockPool.
+ */
+struct PoolStats {
+    size_t hits = 0;            /*< The allocations served from the cache. */
+    size_t misses = 0;          /*< The allocations that went to the heap. */
+    size_t cached_bytes = 0;    /*< The total size of the cached blocks. */
+};
+
+/**
+ * @brief The ThreadBlockPool class keeps the freed blocks of one thread in free lists by power-of-two size class,
+ * from 16 bytes to kMaxBlockBytes, and hands them out again to later allocations of the same class.
+ * Each thread owns its pool, so no lock is taken. A block freed on another thread than the one that
+ * allocated it joins the pool of the freeing thread. The cached blocks are released when the thread exits.
+ */
+class ThreadBlockPool {
+    public:
+        static constexpr size_t kMinBlockShift = 4;
+        static constexpr size_t kMaxBlockShift = 20;
+        static constexpr size_t kMaxBlockBytes = size_t(1) << kMaxBlockShift;   /*< The largest size class. */
+
+        ThreadBlockPool(const ThreadBlockPool&) = delete;
+        ThreadBlockPool& operator=(const ThreadBlockPool&) = delete;
+
+        /**
+         * @brief Gets the pool of the calling thread.
+         * @return The pool, nullptr while the thread destroys its thread-local objects after the pool.
+         */
+        static ThreadBlockPool* Local() noexcept {
+            if (Destroyed()) {
+                return nullptr;
+            }
+            thread_local ThreadBlockPool pool;
+            return &pool;
+        }
+
+        /**
+         * @brief Gets the size of the class a block of bytes belongs to.
+         * @param bytes The requested size, at most kMaxBlockBytes.
+         * @return The size of the class.
+         */
+        static constexpr size_t ClassBytes(size_t bytes) noexcept {
+            return std::max(std::bit_ceil(bytes), size_t(1) << kMinBlockShift);
+        }
+
+        /**
+         * @brief Allocates a block of the size class of bytes, reusing a cached block if there is one.
+         * @param bytes The requested size, at most kMaxBlockBytes.
+         * @return A pointer to the block.
+         */
+        void* Allocate(size_t bytes) {
+            FreeBlock*& head = lists_[ClassOf(bytes)];
+            if (head != nullptr) {
+                FreeBlock* block = std::exchange(head, head->next);
+                stats_.cached_bytes -= ClassBytes(bytes);
+                ++stats_.hits;
+                return block;
+            }
+            ++stats_.misses;
+            return ::operator new(ClassBytes(bytes));
+        }
+
+        /**
+         * @brief Caches a block for reuse, or frees it if that would exceed the limits.
+         * @param p The pointer to the block.
+         * @param bytes The size the block was allocated for.
+         */
+        void Deallocate(void* p, size_t bytes) noexcept {
+            const size_t class_bytes = ClassBytes(bytes);
+            if (class_bytes > limits_.max_block_bytes || stats_.cached_bytes + class_bytes > limits_.max_cached_bytes) {
+                ::operator delete(p, class_bytes);
+                return;
+            }
+            FreeBlock*& head = lists_[ClassOf(bytes)];
+            head = ::new (p) FreeBlock{head};
+            stats_.cached_bytes += class_bytes;
+        }
+
+        /**
+         * @brief Sets the limits of the pool of the calling thread, the cached blocks beyond them are freed.
+         * @param limits The new limits.
+         */
+        void SetLimits(const PoolLimits& limits) noexcept {
+            limits_ = limits;
+            for (size_t c = 0; c < kClasses; ++c) {
+                if (ClassSize(c) > limits_.max_block_bytes) {
+                    FreeClass(c);
+                }
+            }
+            Trim(limits_.max_cached_bytes);
+        }
+
+        PoolLimits GetLimits() const noexcept {
+            return limits_;
+        }
+
+        PoolStats GetStats() const noexcept {
+            return stats_;
+        }
+
+        /**
+         * @brief Frees cached blocks, the largest first, until at most keep_bytes stay cached.
+         * @param keep_bytes The number of cached bytes to keep.
+         */
+        void Trim(size_t keep_bytes = 0) noexcept {
+            for (size_t c = kClasses; c-- > 0 && stats_.cached_bytes > keep_bytes;) {
+                while (lists_[c] != nullptr && stats_.cached_bytes > keep_bytes) {
+                    FreeHead(c);
+                }
+            }
+        }
+
+    private:
+        static constexpr size_t kClasses = kMaxBlockShift - kMinBlockShift + 1;
+
+        /**
+         * @brief The link stored inside a cached block.
+         */
+        struct FreeBlock {
+            FreeBlock* next;
+        };
+
+        FreeBlock* lists_[kClasses] = {};   /*< The cached blocks of each size class. */
+        PoolLimits limits_;                 /*< The limits of the cache. */
+        PoolStats stats_;                   /*< The counters. */
+
+        ThreadBlockPool() = default;
+
+        ~ThreadBlockPool() {
+            Trim();
+            Destroyed() = true;
+        }
+
+        /**
+         * @brief Tells whether the pool of the calling thread was destroyed. The flag is trivially destructible,
+         * so it can still be read while the thread-local objects constructed before the pool are destroyed.
+         */
+        static bool& Destroyed() noexcept {
+            thread_local bool destroyed = false;
+            return destroyed;
+        }
+
+        static constexpr size_t ClassOf(size_t bytes) noexcept {
+            return std::bit_width(ClassBytes(bytes)) - 1 - kMinBlockShift;
+        }
+
+        static constexpr size_t ClassSize(size_t c) noexcept {
+            return size_t(1) << (c + kMinBlockShift);
+        }
+
+        void FreeHead(size_t c) noexcept {
+            ::operator delete(std::exchange(lists_[c], lists_[c]->next), ClassSize(c));
+            stats_.cached_bytes -= ClassSize(c);
+        }
+
+        void FreeClass(size_t c) noexcept {
+            while (lists_[c] != nullptr) {
+                FreeHead(c);
+            }
+        }
+};
+
+/**
+ * @brief The PoolAllocator class serves blocks of up to ThreadBlockPool::kMaxBlockBytes from the pool
+ * of the calling thread, so vectors created and destroyed in a loop reuse the same blocks without heap calls.
+ * It declares round_capacity, so RawMemory rounds the capacity up to the whole size class of the block.
+ * Larger blocks come from operator new.
+ */
+template <typename T>
+class PoolAllocator {
+    static_assert(alignof(T) <= __STDCPP_DEFAULT_NEW_ALIGNMENT__, "Pooled blocks have the default operator new alignment");
+
+    public:
+        using value_type = T;
+        using is_always_equal = std::true_type;
+
+        PoolAllocator() = default;
+
+        template <typename U>
+        PoolAllocator(const PoolAllocator<U>&) noexcept {}
+
+        /**
+         * @brief Gets the number of elements a block allocated for n elements holds.
+         * @param n The number of elements.
+         * @return The capacity of the block.
+         */
+        static constexpr size_t round_capacity(size_t n) noexcept {
+            if (n == 0 || n > ThreadBlockPool::kMaxBlockBytes / sizeof(T)) {
+                return n;
+            }
+            return ThreadBlockPool::ClassBytes(n * sizeof(T)) / sizeof(T);
+        }
+
+        /**
+         * @brief Allocates memory for the specified number of elements.
+         * @param n The number of elements.
+         * @return A pointer to the allocated memory block.
+         */
+        T* allocate(size_t n) {
+            if (n > ThreadBlockPool::kMaxBlockBytes / sizeof(T)) {
+                return static_cast<T*>(::operator new(n * sizeof(T)));
+            }
+            if (ThreadBlockPool* pool = ThreadBlockPool::Local()) {
+                return static_cast<T*>(pool->Allocate(n * sizeof(T)));
+            }
+            return static_cast<T*>(::operator new(ThreadBlockPool::ClassBytes(n * sizeof(T))));
+        }
+
+        /**
+         * @brief Returns the memory block to the pool of the calling thread.
+         * @param p The pointer to the memory block.
+         * @param n The number of elements the block was allocated for.
+         */
+        void deallocate(T* p, size_t n) noexcept {
+            if (n > ThreadBlockPool::kMaxBlockBytes / sizeof(T)) {
+                ::operator delete(p, n * sizeof(T));
+            }
+            else if (ThreadBlockPool* pool = ThreadBlockPool::Local()) {
+                pool->Deallocate(p, n * sizeof(T));
+            }
+            else {
+                ::operator delete(p, ThreadBlockPool::ClassBytes(n * sizeof(T)));
+            }
+        }
+
+        friend bool operator==(const PoolAllocator&, const PoolAllocator&) noexcept {
+            return true;
+        }
+};
+
+#if defined(__linux__)
+
+/**
+ * @brief NUMA placement of the mapped blocks of a HugePageAllocator.
+ */
+struct NumaPolicy {
+    enum class Mode {
+        DEFAULT,    /*< The process policy, usually the node of the first touching thread. */
+        BIND,       /*< Only the selected nodes. */
+        INTERLEAVE, /*< Pages spread round-robin over the selected nodes. */
+        PREFERRED,  /*< The first selected node, others when it is full. */
+    };
+
+    Mode mode = Mode::DEFAULT;
+    unsigned long nodes = 0; /*< Bit mask of the selected nodes, bit i selects node i. */
+
+    static NumaPolicy Bind(unsigned node) noexcept {
+        return {Mode::BIND, 1ul << node};
+    }
+
+    static NumaPolicy Interleave(unsigned long nodes) noexcept {
+        return {Mode::INTERLEAVE, nodes};
+    }
+
+    static NumaPolicy Preferred(unsigned node) noexcept {
+        return {Mode::PREFERRED, 1ul << node};
+    }
+
+    friend bool operator==(const NumaPolicy&, const NumaPolicy&) noexcept = default;
+};
+
+/**
+ * @brief The HugePageAllocator class maps blocks of at least Threshold bytes directly with mmap,
+ * backs them with 2 MiB pages and places them on NUMA nodes according to a NumaPolicy.
+ * Smaller blocks come from operator new. Mapped blocks are padded to whole huge pages and aligned to them,
+ * they use transparent huge pages (MADV_HUGEPAGE), or the reserved hugetlbfs pool (MAP_HUGETLB) when requested
+ * and available. reallocate() grows mapped blocks with mremap, so RawMemory resizes buffers of trivially
+ * relocatable elements without copying them.
+ * Every instance can release the blocks of any other, the policy only affects new blocks.
+ * @tparam Threshold The size in bytes from which blocks are mapped.
+ */
+template <typename T, size_t Threshold = size_t(2) << 20>
+class HugePageAllocator {
+    public:
+        using value_type = T;
+        using is_always_equal = std::true_type;
+
+        template <typename U>
+        struct rebind {
+            using other = HugePageAllocator<U, Threshold>;
+        };
+
+        /*< The size of the huge pages the mapped blocks are padded and aligned to. */
+        static constexpr size_t kHugePageSize = size_t(2) << 20;
+
+        HugePageAllocator() = default;
+
+        /**
+         * @brief Constructs an allocator placing the mapped blocks according to a NUMA policy.
+         * @param numa The NUMA policy.
+         * @param hugetlb Whether to try the reserved hugetlbfs pool before transparent huge pages.
+         */
+        explicit HugePageAllocator(NumaPolicy numa, bool hugetlb = false) noexcept : numa_(numa), hugetlb_(hugetlb) {}
+
+        template <typename U>
+        HugePageAllocator(const HugePageAllocator<U, Threshold>& other) noexcept : numa_(other.GetNumaPolicy()), hugetlb_(other.UsesHugetlb()) {}
+
+        /**
+         * @brief Allocates memory for the specified number of elements.
+         * Throws std::bad_alloc if the memory can not be mapped and std::system_error if the NUMA policy is rejected.
+         * @param n The number of elements.
+         * @return A pointer to the allocated memory block.
+         */
+        T* allocate(size_t n) {
+            if (!IsMapped(n)) {
+                return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t{alignof(T)}));
+            }
+            return static_cast<T*>(Map(MappedLength(n)));
+        }
+
+        /**
+         * @brief Deallocates the memory block.
+         * @param p The pointer to the memory block.
+         * @param n The number of elements the block was allocated for.
+         */
+        void deallocate(T* p, size_t n) noexcept {
+            if (!IsMapped(n)) {
+                ::operator delete(p, n * sizeof(T), std::align_val_t{alignof(T)});
+                return;
+            }
+            ::munmap(p, MappedLength(n));
+        }
+
+        /**
+         * @brief Resizes the memory block, remapping mapped blocks instead of copying them.
+         * The content is preserved bytewise, on failure the original block is left untouched.
+         * @param p The pointer to the memory block, may be nullptr.
+         * @param old_n The number of elements the block was allocated for.
+         * @param new_n The new number of elements.
+         * @return A pointer to the resized memory block.
+         */
+        T* reallocate(T* p, size_t old_n, size_t new_n) {
+            if (p != nullptr && IsMapped(old_n) && IsMapped(new_n)) {
+                void* block = ::mremap(p, MappedLength(old_n), MappedLength(new_n), MREMAP_MAYMOVE);
+                if (block == MAP_FAILED) {
+                    throw std::bad_alloc();
+                }
+                return static_cast<T*>(block);
+            }
+
+            T* block = allocate(new_n);
+            if (p != nullptr) {
+                std::memcpy(static_cast<void*>(block), static_cast<const void*>(p), std::min(old_n, new_n) * sizeof(T));
+                deallocate(p, old_n);
+            }
+            return block;
+        }
+
+        const NumaPolicy& GetNumaPolicy() const noexcept {
+            return numa_;
+        }
+
+        bool UsesHugetlb() const noexcept {
+            return hugetlb_;
+        }
+
+        friend bool operator==(const HugePageAllocator&, const HugePageAllocator&) noexcept {
+            return true;
+        }
+
+    private:
+        NumaPolicy numa_;       /*< The placement of new mapped blocks. */
+        bool hugetlb_ = false;  /*< Whether to try MAP_HUGETLB first. */
+
+        static constexpr bool IsMapped(size_t n) noexcept {
+            return n * sizeof(T) >= Threshold;
+        }
+
+        static constexpr size_t MappedLength(size_t n) noexcept {
+            return (n * sizeof(T) + kHugePageSize - 1) / kHugePageSize * kHugePageSize;
+        }
+
+        /**
+         * @brief Maps a block aligned to a huge page and applies the huge page advice and the NUMA policy.
+         * Both take effect before the first touch, when the pages are actually placed.
+         * @param length The length of the block, a multiple of kHugePageSize.
+         * @return The address of the block.
+         */
+        void* Map(size_t length) const {
+            void* block = MAP_FAILED;
+            if (hugetlb_) {
+                block = ::mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+            }
+            if (block == MAP_FAILED) {
+                block = MapAligned(length);
+                ::madvise(block, length, MADV_HUGEPAGE);
+            }
+
+            if (numa_.mode != NumaPolicy::Mode::DEFAULT) {
+                const int mode = numa_.mode == NumaPolicy::Mode::BIND ? MPOL_BIND
+                    : numa_.mode == NumaPolicy::Mode::INTERLEAVE ? MPOL_INTERLEAVE
+                    : MPOL_PREFERRED;
+                if (::syscall(SYS_mbind, block, length, mode, &numa_.nodes, sizeof(numa_.nodes) * 8, 0) != 0) {
+                    const int error = errno;
+                    ::munmap(block, length);
+                    throw std::system_error(error, std::generic_category(), "mbind");
+                }
+            }
+            return block;
+        }
+
+        /**
+         * @brief Maps length bytes at an address aligned to kHugePageSize, trimming the excess of a larger mapping.
+         * @param length The length of the block, a multiple of kHugePageSize.
+         * @return The address of the block.
+         */
+        static void* MapAligned(size_t length) {
+            const size_t padded_length = length + kHugePageSize;
+            void* mapping = ::mmap(nullptr, padded_length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (mapping == MAP_FAILED) {
+                throw std::bad_alloc();
+            }
+
+            char* start = static_cast<char*>(mapping);
+            char* block = reinterpret_cast<char*>((reinterpret_cast<uintptr_t>(start) + kHugePageSize - 1) / kHugePageSize * kHugePageSize);
+            if (block != start) {
+                ::munmap(start, block - start);
+            }
+            ::munmap(block + length, start + padded_length - (block + length));
+            return block;
+        }
+};
+
+#endif
@@ -0,0 +1,98 @@
+#pragma once
+
+/**
+ * @file batch_appender.h
+ * @brief Definition of the BatchAppender class, a per-thread buffer that appends to a shared Vector in bulk.
+ */
+
+#include "vector.h"
+
+#include <mutex>
+
+/**
+ * @brief The BatchAppender class collects elements for a Vector shared between threads and splices them
+ * into it in batches, so the lock is taken once per batch instead of once per element.
+ * Each thread uses its own BatchAppender, all of them with the same target and mutex. A flush moves the batch
+ * with a single Append, which reallocates the target at most once. The local buffer keeps its capacity between batches.
+ * @tparam VectorType The type of the target Vector.
+ * @tparam Mutex The type of the mutex guarding the target, any Lockable type.
+ */
+template <typename VectorType, typename Mutex = std::mutex>
+class BatchAppender {
+    public:
+        using value_type = std::remove_cvref_t<decltype(*std::declval<VectorType&>().begin())>;
+
+        /**
+         * @brief Constructor.
+         * @param target The shared Vector receiving the elements.
+         * @param mutex The mutex guarding the target.
+         * @param batch_size The number of elements collected before a flush.
+         */
+        BatchAppender(VectorType& target, Mutex& mutex, size_t batch_size = 1024)
+            : target_(target), mutex_(mutex), batch_size_(batch_size), batch_(target.GetAllocator()) {
+            assert(batch_size_ > 0);
+            batch_.Reserve(batch_size_);
+        }
+
+        BatchAppender(const BatchAppender&) = delete;
+        BatchAppender& operator=(const BatchAppender&) = delete;
+
+        /**
+         * @brief Destructor. Flushes the pending elements, they are lost if the flush throws.
+         * Call Flush explicitly to observe the errors.
+         */
+        ~BatchAppender() {
+            try {
+                Flush();
+            }
+            catch (...) {
+            }
+        }
+
+        /**
+         * @brief Constructs a new element in the local buffer, flushing the buffer once it is full.
+         * @param args The arguments to forward to the constructor.
+         */
+        template <typename... Args>
+        void EmplaceBack(Args&&... args) {
+            batch_.EmplaceBack(std::forward<Args>(args)...);
+            if (batch_.Size() >= batch_size_) {
+                Flush();
+            }
+        }
+
+        template <typename Type>
+        void PushBack(Type&& value) {
+            EmplaceBack(std::forward<Type>(value));
+        }
+
+        /**
+         * @brief Moves the pending elements to the end of the target under the mutex.
+         * The target keeps its content if an exception is thrown. The pending elements are kept as well
+         * when the target can not grow, a throwing move constructor may leave them moved-from.
+         */
+        void Flush() {
+            if (batch_.Size() == 0) {
+                return;
+            }
+            {
+                std::lock_guard lock(mutex_);
+                target_.Append(std::make_move_iterator(batch_.begin()), std::make_move_iterator(batch_.end()));
+            }
+            batch_.Clear();
+        }
+
+        /**
+         * @brief Gets the number of elements waiting for a flush.
+         * @return The number of pending elements.
+         */
+        size_t Pending() const noexcept {
+            return batch_.Size();
+        }
+
+    private:
+        VectorType& target_;    /*< The shared Vector. */
+        Mutex& mutex_;          /*< The mutex guarding the target. */
+        size_t batch_size_;     /*< The number of elements collected before a flush. */
+        VectorType batch_;      /*< The pending elements. */
+};
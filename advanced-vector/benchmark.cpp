@@ -0,0 +1,308 @@
+#include "vector.h"
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace {
+
+// A 64-byte POD, a typical fixed-size record
+struct Pod64 {
+    int64_t key = 0;
+    int64_t payload[7] = {};
+};
+
+using String = std::string;
+using MoveOnly = std::unique_ptr<int>;
+
+// Free functions hide the naming differences, so one benchmark body runs against both std::vector and Vector
+
+template <typename T>
+T MakeValue(int64_t i);
+
+template <>
+int MakeValue<int>(int64_t i) {
+    return static_cast<int>(i);
+}
+
+template <>
+Pod64 MakeValue<Pod64>(int64_t i) {
+    Pod64 pod;
+    pod.key = i;
+    return pod;
+}
+
+template <>
+String MakeValue<String>(int64_t i) {
+    // Longer than the SSO buffer, so every string owns a heap allocation
+    return "a string that does not fit into SSO #" + std::to_string(i);
+}
+
+template <>
+MoveOnly MakeValue<MoveOnly>(int64_t i) {
+    return std::make_unique<int>(static_cast<int>(i));
+}
+
+int64_t Weight(int value) {
+    return value;
+}
+
+int64_t Weight(const Pod64& value) {
+    return value.key;
+}
+
+int64_t Weight(const String& value) {
+    return static_cast<int64_t>(value.size());
+}
+
+int64_t Weight(const MoveOnly& value) {
+    return *value;
+}
+
+template <typename T>
+void PushBack(std::vector<T>& v, T value) {
+    v.push_back(std::move(value));
+}
+
+template <typename T>
+void PushBack(Vector<T>& v, T value) {
+    v.PushBack(std::move(value));
+}
+
+template <typename T>
+void EmplaceBack(std::vector<T>& v, int64_t i) {
+    v.emplace_back(MakeValue<T>(i));
+}
+
+template <typename T>
+void EmplaceBack(Vector<T>& v, int64_t i) {
+    v.EmplaceBack(MakeValue<T>(i));
+}
+
+template <typename T>
+void Reserve(std::vector<T>& v, size_t capacity) {
+    v.reserve(capacity);
+}
+
+template <typename T>
+void Reserve(Vector<T>& v, size_t capacity) {
+    v.Reserve(capacity);
+}
+
+template <typename T>
+void Insert(std::vector<T>& v, size_t index, T value) {
+    v.insert(v.begin() + index, std::move(value));
+}
+
+template <typename T>
+void Insert(Vector<T>& v, size_t index, T value) {
+    v.Insert(v.begin() + index, std::move(value));
+}
+
+template <typename T>
+void Erase(std::vector<T>& v, size_t index) {
+    v.erase(v.begin() + index);
+}
+
+template <typename T>
+void Erase(Vector<T>& v, size_t index) {
+    v.Erase(v.begin() + index);
+}
+
+template <typename T>
+size_t Size(const std::vector<T>& v) {
+    return v.size();
+}
+
+template <typename T>
+size_t Size(const Vector<T>& v) {
+    return v.Size();
+}
+
+template <typename Container>
+Container MakeContainer(int64_t size) {
+    Container v;
+    Reserve(v, size);
+    for (int64_t i = 0; i < size; ++i) {
+        EmplaceBack(v, i);
+    }
+    return v;
+}
+
+enum class Position {
+    FRONT,
+    MIDDLE,
+    BACK,
+};
+
+size_t IndexAt(Position position, size_t size) {
+    switch (position) {
+        case Position::FRONT:
+            return 0;
+        case Position::MIDDLE:
+            return size / 2;
+        case Position::BACK:
+            return size;
+    }
+    return size;
+}
+
+template <typename Container>
+void BM_PushBack(benchmark::State& state) {
+    using T = std::remove_cvref_t<decltype(*std::declval<Container&>().begin())>;
+    for (auto _ : state) {
+        Container v;
+        for (int64_t i = 0; i < state.range(0); ++i) {
+            PushBack(v, MakeValue<T>(i));
+        }
+        benchmark::DoNotOptimize(v.begin());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+template <typename Container>
+void BM_EmplaceBack(benchmark::State& state) {
+    for (auto _ : state) {
+        Container v;
+        for (int64_t i = 0; i < state.range(0); ++i) {
+            EmplaceBack(v, i);
+        }
+        benchmark::DoNotOptimize(v.begin());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+template <typename Container>
+void BM_ReserveThenEmplaceBack(benchmark::State& state) {
+    for (auto _ : state) {
+        Container v;
+        Reserve(v, state.range(0));
+        for (int64_t i = 0; i < state.range(0); ++i) {
+            EmplaceBack(v, i);
+        }
+        benchmark::DoNotOptimize(v.begin());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+template <typename Container>
+void BM_Reserve(benchmark::State& state) {
+    for (auto _ : state) {
+        state.PauseTiming();
+        Container v = MakeContainer<Container>(state.range(0));
+        state.ResumeTiming();
+
+        Reserve(v, state.range(0) * 2);
+        benchmark::DoNotOptimize(v.begin());
+
+        state.PauseTiming();
+        v = Container();
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+template <typename Container, Position position>
+void BM_Insert(benchmark::State& state) {
+    using T = std::remove_cvref_t<decltype(*std::declval<Container&>().begin())>;
+    for (auto _ : state) {
+        Container v;
+        for (int64_t i = 0; i < state.range(0); ++i) {
+            Insert(v, IndexAt(position, Size(v)), MakeValue<T>(i));
+        }
+        benchmark::DoNotOptimize(v.begin());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+template <typename Container, Position position>
+void BM_Erase(benchmark::State& state) {
+    for (auto _ : state) {
+        state.PauseTiming();
+        Container v = MakeContainer<Container>(state.range(0));
+        state.ResumeTiming();
+
+        while (Size(v) != 0) {
+            const size_t size = Size(v);
+            Erase(v, position == Position::BACK ? size - 1 : IndexAt(position, size));
+        }
+        benchmark::DoNotOptimize(v.begin());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+template <typename Container>
+void BM_CopyAssignReuse(benchmark::State& state) {
+    const Container source = MakeContainer<Container>(state.range(0));
+    Container v = MakeContainer<Container>(state.range(0));
+    for (auto _ : state) {
+        v = source;
+        benchmark::DoNotOptimize(v.begin());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+template <typename Container>
+void BM_CopyConstruct(benchmark::State& state) {
+    const Container source = MakeContainer<Container>(state.range(0));
+    for (auto _ : state) {
+        Container v(source);
+        benchmark::DoNotOptimize(v.begin());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+template <typename Container>
+void BM_Iterate(benchmark::State& state) {
+    const Container v = MakeContainer<Container>(state.range(0));
+    for (auto _ : state) {
+        int64_t sum = 0;
+        for (const auto& value : v) {
+            sum += Weight(value);
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+}  // namespace
+
+// Every benchmark is registered for std::vector and Vector, so the results are reported side by side
+#define AV_BENCHMARK_PAIR(func, type, lo, hi)                                          \
+    BENCHMARK_TEMPLATE(func, std::vector<type>)->RangeMultiplier(8)->Range(lo, hi);     \
+    BENCHMARK_TEMPLATE(func, Vector<type>)->RangeMultiplier(8)->Range(lo, hi)
+
+#define AV_BENCHMARK_POSITION_PAIR(func, type, position, lo, hi)                                    \
+    BENCHMARK_TEMPLATE(func, std::vector<type>, position)->RangeMultiplier(8)->Range(lo, hi);        \
+    BENCHMARK_TEMPLATE(func, Vector<type>, position)->RangeMultiplier(8)->Range(lo, hi)
+
+#define AV_BENCHMARK_ALL_OPERATIONS(type)                                                         \
+    AV_BENCHMARK_PAIR(BM_PushBack, type, 8, 1 << 18);                                               \
+    AV_BENCHMARK_PAIR(BM_EmplaceBack, type, 8, 1 << 18);                                            \
+    AV_BENCHMARK_PAIR(BM_ReserveThenEmplaceBack, type, 8, 1 << 18);                                 \
+    AV_BENCHMARK_PAIR(BM_Reserve, type, 512, 1 << 18);                                              \
+    AV_BENCHMARK_POSITION_PAIR(BM_Insert, type, Position::FRONT, 8, 1 << 12);                       \
+    AV_BENCHMARK_POSITION_PAIR(BM_Insert, type, Position::MIDDLE, 8, 1 << 12);                      \
+    AV_BENCHMARK_POSITION_PAIR(BM_Insert, type, Position::BACK, 8, 1 << 12);                        \
+    AV_BENCHMARK_POSITION_PAIR(BM_Erase, type, Position::FRONT, 512, 1 << 12);                      \
+    AV_BENCHMARK_POSITION_PAIR(BM_Erase, type, Position::MIDDLE, 512, 1 << 12);                     \
+    AV_BENCHMARK_POSITION_PAIR(BM_Erase, type, Position::BACK, 512, 1 << 12);                       \
+    AV_BENCHMARK_PAIR(BM_Iterate, type, 8, 1 << 18)
+
+#define AV_BENCHMARK_COPY_OPERATIONS(type)                                                        \
+    AV_BENCHMARK_PAIR(BM_CopyAssignReuse, type, 8, 1 << 18);                                        \
+    AV_BENCHMARK_PAIR(BM_CopyConstruct, type, 8, 1 << 18)
+
+AV_BENCHMARK_ALL_OPERATIONS(int);
+AV_BENCHMARK_ALL_OPERATIONS(Pod64);
+AV_BENCHMARK_ALL_OPERATIONS(String);
+AV_BENCHMARK_ALL_OPERATIONS(MoveOnly);
+
+AV_BENCHMARK_COPY_OPERATIONS(int);
+AV_BENCHMARK_COPY_OPERATIONS(Pod64);
+AV_BENCHMARK_COPY_OPERATIONS(String);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,500 @@
+#pragma once
+
+/**
+ * @file bit_vector.h
+ * @brief Definitions of the BitVector and PackedIntVector classes, vectors of bits and of k-bit integers packed into words.
+ */
+
+#include "vector.h"
+
+#include <bit>
+#include <cstdint>
+#include <span>
+
+/**
+ * @brief The BitVector class stores bits packed into 64-bit words held by a Vector, one bit per flag instead of one byte.
+ * Counting, rank, select and the bitwise operations work a word at a time, in loops the compiler vectorizes.
+ * The bits past Size() in the last word are kept zero, so whole words can be counted and compared.
+ */
+template <typename Alloc = std::allocator<uint64_t>>
+class BitVector {
+    public:
+        using allocator_type = Alloc;
+
+        static constexpr size_t kWordBits = 64;
+
+        BitVector() = default;
+
+        /**
+         * @brief Constructs a BitVector of size bits, all set to value.
+         * @param size The number of bits.
+         * @param value The value of the bits.
+         */
+        explicit BitVector(size_t size, bool value = false, const Alloc& alloc = Alloc()) : words_(alloc) {
+            Resize(size, value);
+        }
+
+        size_t Size() const noexcept {
+            return size_;
+        }
+
+        /**
+         * @brief Gets the number of bits the allocated words have room for.
+         * @return The capacity in bits.
+         */
+        size_t Capacity() const noexcept {
+            return words_.Capacity() * kWordBits;
+        }
+
+        allocator_type GetAllocator() const noexcept {
+            return words_.GetAllocator();
+        }
+
+        /**
+         * @brief Gets the words holding the bits, bit i is bit i % 64 of word i / 64.
+         * @return A span over the words.
+         */
+        std::span<const uint64_t> Words() const noexcept {
+            return {words_.begin(), words_.Size()};
+        }
+
+        bool operator[](size_t index) const noexcept {
+            return Get(index);
+        }
+
+        bool Get(size_t index) const noexcept {
+            assert(index < size_);
+            return (words_[index / kWordBits] >> (index % kWordBits)) & 1;
+        }
+
+        void Set(size_t index, bool value = true) noexcept {
+            assert(index < size_);
+            const uint64_t mask = uint64_t(1) << (index % kWordBits);
+            uint64_t& word = words_[index / kWordBits];
+            word = value ? word | mask : word & ~mask;
+        }
+
+        void Reset(size_t index) noexcept {
+            Set(index, false);
+        }
+
+        void Flip(size_t index) noexcept {
+            assert(index < size_);
+            words_[index / kWordBits] ^= uint64_t(1) << (index % kWordBits);
+        }
+
+        /**
+         * @brief Reserves room for new_capacity bits.
+         * @param new_capacity The number of bits.
+         */
+        void Reserve(size_t new_capacity) {
+            words_.Reserve(WordsFor(new_capacity));
+        }
+
+        /**
+         * @brief Resizes the BitVector, new bits are set to value.
+         * @param new_size The new number of bits.
+         * @param value The value of the new bits.
+         */
+        void Resize(size_t new_size, bool value = false) {
+            if (new_size <= size_) {
+                size_ = new_size;
+                words_.Resize(WordsFor(new_size));
+                ClearTail();
+                return;
+            }
+            if (value && size_ % kWordBits != 0) {
+                words_[words_.Size() - 1] |= ~uint64_t(0) << (size_ % kWordBits);
+            }
+            const size_t old_words = words_.Size();
+            words_.Resize(WordsFor(new_size));
+            if (value) {
+                std::fill(words_.begin() + old_words, words_.end(), ~uint64_t(0));
+            }
+            size_ = new_size;
+            ClearTail();
+        }
+
+        void PushBack(bool value) {
+            AppendBits(value, 1);
+        }
+
+        /**
+         * @brief Appends the count low bits of a word at once, the lowest bit first.
+         * @param bits The bits to append, the bits above count are ignored.
+         * @param count The number of bits, at most 64.
+         */
+        void AppendBits(uint64_t bits, size_t count) {
+            assert(count <= kWordBits);
+            if (count == 0) {
+                return;
+            }
+            if (count < kWordBits) {
+                bits &= (uint64_t(1) << count) - 1;
+            }
+            const size_t offset = size_ % kWordBits;
+            if (offset == 0) {
+                words_.PushBack(bits);
+            }
+            else {
+                words_[words_.Size() - 1] |= bits << offset;
+                if (offset + count > kWordBits) {
+                    words_.PushBack(bits >> (kWordBits - offset));
+                }
+            }
+            size_ += count;
+        }
+
+        void PopBack() noexcept {
+            assert(size_ != 0);
+            Resize(size_ - 1);
+        }
+
+        void Clear() noexcept {
+            words_.Clear();
+            size_ = 0;
+        }
+
+        /**
+         * @brief Counts the set bits.
+         * @return The number of set bits.
+         */
+        size_t Count() const noexcept {
+            return CountWords(words_.Size());
+        }
+
+        bool Any() const noexcept {
+            return std::any_of(words_.begin(), words_.end(), [](uint64_t word) { return word != 0; });
+        }
+
+        bool None() const noexcept {
+            return !Any();
+        }
+
+        bool All() const noexcept {
+            return Count() == size_;
+        }
+
+        /**
+         * @brief Counts the set bits before a position.
+         * @param index The position, at most Size().
+         * @return The number of set bits in [0, index).
+         */
+        size_t Rank(size_t index) const noexcept {
+            assert(index <= size_);
+            const size_t full = index / kWordBits;
+            size_t rank = CountWords(full);
+            if (index % kWordBits != 0) {
+                rank += std::popcount(words_[full] & ((uint64_t(1) << (index % kWordBits)) - 1));
+            }
+            return rank;
+        }
+
+        /**
+         * @brief Finds the position of the set bit of the given rank.
+         * @param rank The number of set bits before the bit to find, counting from 0.
+         * @return The position of the bit, Size() if fewer bits are set.
+         */
+        size_t Select(size_t rank) const noexcept {
+            for (size_t w = 0; w < words_.Size(); ++w) {
+                const size_t count = std::popcount(words_[w]);
+                if (rank < count) {
+                    uint64_t word = words_[w];
+                    for (; rank > 0; --rank) {
+                        word &= word - 1;
+                    }
+                    return w * kWordBits + std::countr_zero(word);
+                }
+                rank -= count;
+            }
+            return size_;
+        }
+
+        /**
+         * @brief Calls f(index) for every set bit in increasing order.
+         * @param f The callback.
+         */
+        template <typename F>
+        void ForEachSetBit(F f) const {
+            for (size_t w = 0; w < words_.Size(); ++w) {
+                for (uint64_t word = words_[w]; word != 0; word &= word - 1) {
+                    f(w * kWordBits + std::countr_zero(word));
+                }
+            }
+        }
+
+        /**
+         * @brief Flips all bits.
+         */
+        void FlipAll() noexcept {
+            for (uint64_t& word : words_) {
+                word = ~word;
+            }
+            ClearTail();
+        }
+
+        BitVector& operator&=(const BitVector& rhs) noexcept {
+            return Combine(rhs, [](uint64_t a, uint64_t b) { return a & b; });
+        }
+
+        BitVector& operator|=(const BitVector& rhs) noexcept {
+            return Combine(rhs, [](uint64_t a, uint64_t b) { return a | b; });
+        }
+
+        BitVector& operator^=(const BitVector& rhs) noexcept {
+            return Combine(rhs, [](uint64_t a, uint64_t b) { return a ^ b; });
+        }
+
+        /**
+         * @brief Clears the bits that are set in rhs.
+         * @param rhs A BitVector of the same size.
+         * @return A reference to the current BitVector.
+         */
+        BitVector& AndNot(const BitVector& rhs) noexcept {
+            return Combine(rhs, [](uint64_t a, uint64_t b) { return a & ~b; });
+        }
+
+        void Swap(BitVector& other) noexcept {
+            words_.Swap(other.words_);
+            std::swap(size_, other.size_);
+        }
+
+        friend bool operator==(const BitVector& lhs, const BitVector& rhs) noexcept {
+            return lhs.size_ == rhs.size_ && lhs.words_ == rhs.words_;
+        }
+
+    private:
+        Vector<uint64_t, Alloc> words_;     /*< The words holding the bits. */
+        size_t size_ = 0;                   /*< The number of bits. */
+
+        static constexpr size_t WordsFor(size_t bits) noexcept {
+            return (bits + kWordBits - 1) / kWordBits;
+        }
+
+        /**
+         * @brief Clears the bits past Size() in the last word.
+         */
+        void ClearTail() noexcept {
+            if (size_ % kWordBits != 0) {
+                words_[words_.Size() - 1] &= (uint64_t(1) << (size_ % kWordBits)) - 1;
+            }
+        }
+
+        size_t CountWords(size_t count) const noexcept {
+            size_t total = 0;
+            for (size_t w = 0; w < count; ++w) {
+                total += std::popcount(words_[w]);
+            }
+            return total;
+        }
+
+        template <typename Op>
+        BitVector& Combine(const BitVector& rhs, Op op) noexcept {
+            assert(size_ == rhs.size_);
+            uint64_t* lhs_words = words_.begin();
+            const uint64_t* rhs_words = rhs.words_.begin();
+            for (size_t w = 0; w < words_.Size(); ++w) {
+                lhs_words[w] = op(lhs_words[w], rhs_words[w]);
+            }
+            return *this;
+        }
+};
+
+/**
+ * @brief The PackedIntVector class stores unsigned integers of Bits bits back to back in 64-bit words,
+ * so codes with a small range take Bits bits each instead of a whole integer type.
+ * An element may straddle two words. Unpack decodes runs of elements into a plain array, 64 elements
+ * at a time, whose bit offsets repeat and fold into constants.
+ * @tparam Bits The width of an element in bits, from 1 to 64.
+ */
+template <size_t Bits, typename Alloc = std::allocator<uint64_t>>
+class PackedIntVector {
+    static_assert(Bits >= 1 && Bits <= 64, "Bits must be between 1 and 64");
+
+    public:
+        using allocator_type = Alloc;
+
+        static constexpr size_t kWordBits = 64;
+        /*< The largest value an element can hold. */
+        static constexpr uint64_t kMaxValue = Bits == kWordBits ? ~uint64_t(0) : (uint64_t(1) << Bits) - 1;
+
+        PackedIntVector() = default;
+
+        /**
+         * @brief Constructs a PackedIntVector of size zero elements.
+         * @param size The number of elements.
+         */
+        explicit PackedIntVector(size_t size, const Alloc& alloc = Alloc()) : words_(alloc) {
+            Resize(size);
+        }
+
+        size_t Size() const noexcept {
+            return size_;
+        }
+
+        allocator_type GetAllocator() const noexcept {
+            return words_.GetAllocator();
+        }
+
+        /**
+         * @brief Gets the words holding the elements, element i starts at bit i * Bits.
+         * @return A span over the words.
+         */
+        std::span<const uint64_t> Words() const noexcept {
+            return {words_.begin(), words_.Size()};
+        }
+
+        uint64_t operator[](size_t index) const noexcept {
+            return Get(index);
+        }
+
+        uint64_t Get(size_t index) const noexcept {
+            assert(index < size_);
+            return Extract(words_.begin(), index * Bits);
+        }
+
+        /**
+         * @brief Sets an element.
+         * @param index The index of the element.
+         * @param value The new value, at most kMaxValue.
+         */
+        void Set(size_t index, uint64_t value) noexcept {
+            assert(index < size_ && value <= kMaxValue);
+            const size_t bit = index * Bits;
+            const size_t offset = bit % kWordBits;
+            uint64_t* word = words_.begin() + bit / kWordBits;
+            word[0] = (word[0] & ~(kMaxValue << offset)) | (value << offset);
+            if (kStraddles && offset + Bits > kWordBits) {
+                const size_t high = kWordBits - offset;
+                word[1] = (word[1] & ~(kMaxValue >> high)) | (value >> high);
+            }
+        }
+
+        void Reserve(size_t new_capacity) {
+            words_.Reserve(WordsFor(new_capacity));
+        }
+
+        /**
+         * @brief Resizes the PackedIntVector, new elements are zero.
+         * @param new_size The new number of elements.
+         */
+        void Resize(size_t new_size) {
+            const size_t old_size = size_;
+            words_.Resize(WordsFor(new_size));
+            size_ = new_size;
+            if (new_size < old_size) {
+                ClearTail();
+            }
+        }
+
+        /**
+         * @brief Appends an element.
+         * @param value The value, at most kMaxValue.
+         */
+        void PushBack(uint64_t value) {
+            assert(value <= kMaxValue);
+            const size_t offset = size_ * Bits % kWordBits;
+            if (offset == 0) {
+                words_.PushBack(value);
+            }
+            else {
+                words_[words_.Size() - 1] |= value << offset;
+                if (kStraddles && offset + Bits > kWordBits) {
+                    words_.PushBack(value >> (kWordBits - offset));
+                }
+            }
+            ++size_;
+        }
+
+        /**
+         * @brief Appends count elements, growing the words once.
+         * @param values The values, each at most kMaxValue.
+         * @param count The number of values.
+         */
+        template <typename Int>
+        void Append(const Int* values, size_t count) {
+            words_.Reserve(WordsFor(size_ + count));
+            for (size_t i = 0; i < count; ++i) {
+                PushBack(static_cast<uint64_t>(values[i]));
+            }
+        }
+
+        void PopBack() noexcept {
+            assert(size_ != 0);
+            Resize(size_ - 1);
+        }
+
+        void Clear() noexcept {
+            words_.Clear();
+            size_ = 0;
+        }
+
+        /**
+         * @brief Decodes count elements starting at first into a plain array.
+         * Whole groups of 64 elements span exactly Bits words, so their offsets are the same in every group.
+         * @param first The index of the first element.
+         * @param count The number of elements.
+         * @param out The destination, of an integer type wide enough for Bits bits.
+         */
+        template <typename Int>
+        void Unpack(size_t first, size_t count, Int* out) const noexcept {
+            assert(first <= size_ && count <= size_ - first);
+            const uint64_t* words = words_.begin();
+            size_t i = 0;
+            for (; i < count && (first + i) % kWordBits != 0; ++i) {
+                out[i] = static_cast<Int>(Extract(words, (first + i) * Bits));
+            }
+            for (; i + kWordBits <= count; i += kWordBits) {
+                const uint64_t* group = words + (first + i) / kWordBits * Bits;
+                for (size_t j = 0; j < kWordBits; ++j) {
+                    out[i + j] = static_cast<Int>(Extract(group, j * Bits));
+                }
+            }
+            for (; i < count; ++i) {
+                out[i] = static_cast<Int>(Extract(words, (first + i) * Bits));
+            }
+        }
+
+        void Swap(PackedIntVector& other) noexcept {
+            words_.Swap(other.words_);
+            std::swap(size_, other.size_);
+        }
+
+        friend bool operator==(const PackedIntVector& lhs, const PackedIntVector& rhs) noexcept {
+            return lhs.size_ == rhs.size_ && lhs.words_ == rhs.words_;
+        }
+
+    private:
+        /*< Whether an element can straddle two words, never when Bits divides 64. */
+        static constexpr bool kStraddles = kWordBits % Bits != 0;
+
+        Vector<uint64_t, Alloc> words_;     /*< The words holding the elements. */
+        size_t size_ = 0;                   /*< The number of elements. */
+
+        static constexpr size_t WordsFor(size_t size) noexcept {
+            return (size * Bits + kWordBits - 1) / kWordBits;
+        }
+
+        /**
+         * @brief Reads the element starting at a bit position.
+         */
+        static uint64_t Extract(const uint64_t* words, size_t bit) noexcept {
+            const size_t offset = bit % kWordBits;
+            const uint64_t* word = words + bit / kWordBits;
+            uint64_t value = word[0] >> offset;
+            if (kStraddles && offset + Bits > kWordBits) {
+                value |= word[1] << (kWordBits - offset);
+            }
+            return value & kMaxValue;
+        }
+
+        /**
+         * @brief Clears the bits past the last element, so that equal contents have equal words.
+         */
+        void ClearTail() noexcept {
+            const size_t used = size_ * Bits % kWordBits;
+            if (used != 0) {
+                words_[words_.Size() - 1] &= (uint64_t(1) << used) - 1;
+            }
+        }
+};
@@ -0,0 +1,517 @@
+#pragma once
+
+/**
+ * @file compact_vector.h
+ * @brief Definition of the CompactVector class, a vector that is a single pointer.
+ */
+
+#include "vector.h"
+
+#include <cstdint>
+#include <initializer_list>
+#include <limits>
+#include <stdexcept>
+
+/**
+ * @brief The CompactVector class is a vector whose object is a single pointer to the elements.
+ * The size and the capacity are stored as 32-bit integers in a header in front of the elements,
+ * and an empty CompactVector without a buffer is a null pointer, so it costs 8 bytes instead of the 24 of a Vector
+ * when it is embedded in other objects. Reading the size loads the header, which shares a cache line with the first elements.
+ * The interface follows Vector. The size is limited to 2^32 - 1 elements.
+ * The allocator is not stored, so all instances of it must compare equal.
+ */
+template <typename T, typename Alloc = std::allocator<T>>
+class CompactVector {
+    using AllocTraits = std::allocator_traits<Alloc>;
+
+    static_assert(AllocTraits::is_always_equal::value, "CompactVector stores no allocator, all allocators must compare equal");
+
+    public:
+        using value_type = T;
+        using allocator_type = Alloc;
+        using iterator = T*;
+        using const_iterator = const T*;
+
+        /*< The largest number of elements. */
+        static constexpr size_t kMaxSize = std::numeric_limits<uint32_t>::max();
+
+        CompactVector() = default;
+
+        explicit CompactVector(const Alloc&) noexcept {}
+
+        /**
+         * @brief Constructs a CompactVector of value-initialized elements.
+         * @param size The initial size.
+         */
+        explicit CompactVector(size_t size, const Alloc& = Alloc()) {
+            if (size != 0) {
+                T* data = Allocate(size);
+                try {
+                    detail::UninitializedValueConstructN(alloc_, data, size);
+                }
+                catch (...) {
+                    Deallocate(data);
+                    throw;
+                }
+                data_ = data;
+                SetSize(size);
+            }
+        }
+
+        /**
+         * @brief Constructs a CompactVector from a range, forward ranges are allocated for once.
+         * @param first The iterator to the first element of the range.
+         * @param last The iterator past the last element of the range.
+         */
+        template <std::input_iterator InputIt>
+        CompactVector(InputIt first, InputIt last, const Alloc& alloc = Alloc()) : CompactVector(alloc) {
+            if constexpr (detail::MultiPassIterator<InputIt>) {
+                Reserve(static_cast<size_t>(std::distance(first, last)));
+            }
+            for (; first != last; ++first) {
+                EmplaceBack(*first);
+            }
+        }
+
+        CompactVector(std::initializer_list<T> init, const Alloc& alloc = Alloc()) : CompactVector(init.begin(), init.end(), alloc) {}
+
+        CompactVector(const CompactVector& other) {
+            if (other.Size() != 0) {
+                T* data = Allocate(other.Size());
+                try {
+                    detail::UninitializedCopyN(alloc_, other.data_, other.Size(), data);
+                }
+                catch (...) {
+                    Deallocate(data);
+                    throw;
+                }
+                data_ = data;
+                SetSize(other.Size());
+            }
+        }
+
+        CompactVector(CompactVector&& other) noexcept : data_(std::exchange(other.data_, nullptr)) {}
+
+        ~CompactVector() {
+            Clear();
+            Deallocate(data_);
+        }
+
+        /**
+         * @brief Copy assignment operator, assigns over the existing elements when the capacity suffices.
+         * @param rhs The other CompactVector object to copy from.
+         * @return A reference to the current CompactVector object.
+         */
+        CompactVector& operator=(const CompactVector& rhs) {
+            if (this == &rhs) {
+                return *this;
+            }
+            if (rhs.Size() > Capacity()) {
+                CompactVector copy(rhs);
+                Swap(copy);
+                return *this;
+            }
+
+            const size_t common = std::min(Size(), rhs.Size());
+            std::copy_n(rhs.data_, common, data_);
+            if (rhs.Size() > Size()) {
+                detail::UninitializedCopyN(alloc_, rhs.data_ + common, rhs.Size() - common, data_ + common);
+            }
+            else if (data_ != nullptr) {
+                detail::DestroyN(alloc_, data_ + common, Size() - common);
+            }
+            if (data_ != nullptr) {
+                SetSize(rhs.Size());
+            }
+            return *this;
+        }
+
+        CompactVector& operator=(CompactVector&& rhs) noexcept {
+            if (this != &rhs) {
+                Clear();
+                Deallocate(std::exchange(data_, std::exchange(rhs.data_, nullptr)));
+            }
+            return *this;
+        }
+
+        iterator begin() noexcept {
+            return data_;
+        }
+
+        iterator end() noexcept {
+            return data_ + Size();
+        }
+
+        const_iterator begin() const noexcept {
+            return data_;
+        }
+
+        const_iterator end() const noexcept {
+            return data_ + Size();
+        }
+
+        const_iterator cbegin() const noexcept {
+            return begin();
+        }
+
+        const_iterator cend() const noexcept {
+            return end();
+        }
+
+        size_t Size() const noexcept {
+            return data_ != nullptr ? GetHeader(data_)->size : 0;
+        }
+
+        size_t Capacity() const noexcept {
+            return data_ != nullptr ? GetHeader(data_)->capacity : 0;
+        }
+
+        allocator_type GetAllocator() const noexcept {
+            return alloc_;
+        }
+
+        const T& operator[](size_t index) const noexcept {
+            return const_cast<CompactVector&>(*this)[index];
+        }
+
+        T& operator[](size_t index) noexcept {
+            assert(index < Size());
+            return data_[index];
+        }
+
+        /**
+         * @brief Reserves capacity for the CompactVector.
+         * @param new_capacity The new capacity to reserve.
+         */
+        void Reserve(size_t new_capacity) {
+            if (new_capacity > Capacity()) {
+                Reallocate(new_capacity);
+            }
+        }
+
+        /**
+         * @brief Resizes the CompactVector, new elements are value-initialized.
+         * @param new_size The new size.
+         */
+        void Resize(size_t new_size) {
+            const size_t size = Size();
+            if (new_size < size) {
+                detail::DestroyN(alloc_, data_ + new_size, size - new_size);
+                SetSize(new_size);
+            }
+            else if (new_size > size) {
+                if (new_size > Capacity()) {
+                    Reallocate(NextCapacity(new_size));
+                }
+                detail::UninitializedValueConstructN(alloc_, data_ + size, new_size - size);
+                SetSize(new_size);
+            }
+        }
+
+        /**
+         * @brief Reduces the capacity to the size, an empty CompactVector releases its buffer and becomes a null pointer.
+         */
+        void ShrinkToFit() {
+            if (Size() == 0) {
+                Deallocate(std::exchange(data_, nullptr));
+            }
+            else if (Size() < Capacity()) {
+                Reallocate(Size());
+            }
+        }
+
+        /**
+         * @brief Emplaces a new element at the end of the CompactVector.
+         * @param args The arguments to forward, they may refer to an element of the CompactVector.
+         * @return A reference to the emplaced element.
+         */
+        template <typename... Args>
+        T& EmplaceBack(Args&&... args) {
+            const size_t size = Size();
+            if (size == Capacity()) {
+                return *EmplaceWithReallocation(size, std::forward<Args>(args)...);
+            }
+            detail::ConstructAt(alloc_, data_ + size, std::forward<Args>(args)...);
+            SetSize(size + 1);
+            return data_[size];
+        }
+
+        template <typename Type>
+        void PushBack(Type&& value) {
+            EmplaceBack(std::forward<Type>(value));
+        }
+
+        void PopBack() noexcept {
+            assert(Size() != 0);
+            detail::DestroyAt(alloc_, data_ + Size() - 1);
+            SetSize(Size() - 1);
+        }
+
+        /**
+         * @brief Emplaces a new element at the specified position, the following elements are shifted by one.
+         * @param pos The position at which to emplace the element.
+         * @param args The arguments to forward.
+         * @return An iterator pointing to the emplaced element.
+         */
+        template <typename... Args>
+        iterator Emplace(const_iterator pos, Args&&... args) {
+            assert(pos >= begin() && pos <= end());
+            const size_t index = pos - begin();
+            const size_t size = Size();
+            if (size == Capacity()) {
+                return EmplaceWithReallocation(index, std::forward<Args>(args)...);
+            }
+            if (index == size) {
+                detail::ConstructAt(alloc_, data_ + size, std::forward<Args>(args)...);
+            }
+            else {
+                T value(std::forward<Args>(args)...);
+                detail::ConstructAt(alloc_, data_ + size, std::move(data_[size - 1]));
+                try {
+                    std::move_backward(data_ + index, data_ + size - 1, data_ + size);
+                    data_[index] = std::move(value);
+                }
+                catch (...) {
+                    detail::DestroyAt(alloc_, data_ + size);
+                    throw;
+                }
+            }
+            SetSize(size + 1);
+            return data_ + index;
+        }
+
+        iterator Insert(const_iterator pos, const T& item) {
+            return Emplace(pos, item);
+        }
+
+        iterator Insert(const_iterator pos, T&& item) {
+            return Emplace(pos, std::move(item));
+        }
+
+        /**
+         * @brief Inserts the elements of a range at the specified position.
+         * The elements are appended, forward ranges after growing once, and rotated into place.
+         * The range must not refer to the elements of the CompactVector.
+         * @param pos The position at which to insert the elements.
+         * @param first The iterator to the first element of the range.
+         * @param last The iterator past the last element of the range.
+         * @return An iterator pointing to the first inserted element.
+         */
+        template <std::input_iterator InputIt>
+        iterator Insert(const_iterator pos, InputIt first, InputIt last) {
+            assert(pos >= begin() && pos <= end());
+            const size_t index = pos - begin();
+            const size_t size = Size();
+            if constexpr (detail::MultiPassIterator<InputIt>) {
+                const size_t required = size + static_cast<size_t>(std::distance(first, last));
+                if (required > Capacity()) {
+                    Reallocate(NextCapacity(required));
+                }
+            }
+            for (; first != last; ++first) {
+                EmplaceBack(*first);
+            }
+            std::rotate(begin() + index, begin() + size, end());
+            return begin() + index;
+        }
+
+        iterator Erase(const_iterator pos) {
+            assert(pos >= begin() && pos < end());
+            return Erase(pos, pos + 1);
+        }
+
+        /**
+         * @brief Erases the elements in the range [first, last), shifting the tail once.
+         * @param first The position of the first element to erase.
+         * @param last The position past the last element to erase.
+         * @return An iterator pointing to the element following the erased elements.
+         */
+        iterator Erase(const_iterator first, const_iterator last) {
+            assert(first >= begin() && first <= last && last <= end());
+            const size_t index = first - begin();
+            const size_t count = last - first;
+            if (count == 0) {
+                return begin() + index;
+            }
+            T* pos = data_ + index;
+
+            if constexpr (detail::kRelocatesBitwise<Alloc, T>) {
+                detail::DestroyN(alloc_, pos, count);
+                std::memmove(static_cast<void*>(pos), static_cast<const void*>(pos + count), (Size() - index - count) * sizeof(T));
+            }
+            else {
+                std::move(pos + count, end(), pos);
+                detail::DestroyN(alloc_, end() - count, count);
+            }
+            SetSize(Size() - count);
+            return begin() + index;
+        }
+
+        /**
+         * @brief Destroys all elements, the capacity is kept.
+         */
+        void Clear() noexcept {
+            if (data_ != nullptr) {
+                detail::DestroyN(alloc_, data_, Size());
+                SetSize(0);
+            }
+        }
+
+        void Swap(CompactVector& other) noexcept {
+            std::swap(data_, other.data_);
+        }
+
+    private:
+        /**
+         * @brief The header in front of the elements.
+         */
+        struct Header {
+            uint32_t size;      /*< The number of elements. */
+            uint32_t capacity;  /*< The number of elements the block has room for. */
+        };
+
+        static constexpr size_t kAlignment = std::max(alignof(Header), alignof(T));
+        /*< The offset of the elements from the start of the block, the header padded to the alignment of T. */
+        static constexpr size_t kHeaderBytes = (sizeof(Header) + alignof(T) - 1) / alignof(T) * alignof(T);
+
+        /**
+         * @brief The unit the blocks are allocated in, so the rebound allocator returns storage aligned for both parts.
+         */
+        struct alignas(kAlignment) Unit {
+            unsigned char bytes[kAlignment];
+        };
+
+        using UnitAlloc = typename AllocTraits::template rebind_alloc<Unit>;
+        using UnitTraits = std::allocator_traits<UnitAlloc>;
+
+        [[no_unique_address]] Alloc alloc_;     /*< The allocator of the elements, stateless. */
+        T* data_ = nullptr;                     /*< The first element, the header lies right before it. nullptr without a buffer. */
+
+        static Header* GetHeader(T* data) noexcept {
+            return reinterpret_cast<Header*>(reinterpret_cast<unsigned char*>(data) - kHeaderBytes);
+        }
+
+        static constexpr size_t UnitsFor(size_t capacity) noexcept {
+            return (kHeaderBytes + capacity * sizeof(T) + sizeof(Unit) - 1) / sizeof(Unit);
+        }
+
+        void SetSize(size_t size) noexcept {
+            GetHeader(data_)->size = static_cast<uint32_t>(size);
+        }
+
+        /**
+         * @brief Allocates a block for capacity elements with an empty header.
+         * @param capacity The number of elements, not zero.
+         * @return The address of the first element.
+         */
+        T* Allocate(size_t capacity) {
+            if (capacity > kMaxSize) {
+                throw std::length_error("CompactVector can not hold more than 2^32 - 1 elements");
+            }
+            UnitAlloc alloc(alloc_);
+            unsigned char* block = reinterpret_cast<unsigned char*>(UnitTraits::allocate(alloc, UnitsFor(capacity)));
+            ::new (static_cast<void*>(block)) Header{0, static_cast<uint32_t>(capacity)};
+            return reinterpret_cast<T*>(block + kHeaderBytes);
+        }
+
+        /**
+         * @brief Deallocates the block of data, the elements must be destroyed.
+         * @param data The address of the first element, may be nullptr.
+         */
+        void Deallocate(T* data) noexcept {
+            if (data != nullptr) {
+                UnitAlloc alloc(alloc_);
+                Header* header = GetHeader(data);
+                UnitTraits::deallocate(alloc, reinterpret_cast<Unit*>(header), UnitsFor(header->capacity));
+            }
+        }
+
+        /**
+         * @brief Gets the capacity to grow to, doubling the current one up to kMaxSize.
+         * @param required The number of elements to hold.
+         */
+        size_t NextCapacity(size_t required) const {
+            if (required > kMaxSize) {
+                throw std::length_error("CompactVector can not hold more than 2^32 - 1 elements");
+            }
+            return std::max(required, std::min(Capacity() * 2, kMaxSize));
+        }
+
+        /**
+         * @brief Relocates the elements into a new block of new_capacity, gives the strong guarantee.
+         * @param new_capacity The new capacity, not less than the size.
+         */
+        void Reallocate(size_t new_capacity) {
+            const size_t size = Size();
+            T* data = Allocate(new_capacity);
+            try {
+                detail::UninitializedRelocateN(alloc_, data_, size, data);
+            }
+            catch (...) {
+                Deallocate(data);
+                throw;
+            }
+            Deallocate(std::exchange(data_, data));
+            SetSize(size);
+        }
+
+        /**
+         * @brief Grows the block and emplaces a new element at the specified position.
+         * The element is constructed before the old elements are relocated, so args may refer to them.
+         * @param index The position of the new element.
+         * @param args The arguments to forward.
+         * @return A pointer to the emplaced element.
+         */
+        template <typename... Args>
+        T* EmplaceWithReallocation(size_t index, Args&&... args) {
+            const size_t size = Size();
+            T* data = Allocate(NextCapacity(size + 1));
+            T* slot = data + index;
+            try {
+                detail::ConstructAt(alloc_, slot, std::forward<Args>(args)...);
+            }
+            catch (...) {
+                Deallocate(data);
+                throw;
+            }
+
+            if constexpr (detail::kRelocatesBitwise<Alloc, T>) {
+                detail::UninitializedRelocateN(alloc_, data_, index, data);
+                detail::UninitializedRelocateN(alloc_, data_ + index, size - index, slot + 1);
+            }
+            else {
+                try {
+                    detail::UninitializedMoveIfNoexceptN(alloc_, data_, index, data);
+                    try {
+                        detail::UninitializedMoveIfNoexceptN(alloc_, data_ + index, size - index, slot + 1);
+                    }
+                    catch (...) {
+                        detail::DestroyN(alloc_, data, index);
+                        throw;
+                    }
+                }
+                catch (...) {
+                    detail::DestroyAt(alloc_, slot);
+                    Deallocate(data);
+                    throw;
+                }
+                detail::DestroyN(alloc_, data_, size);
+            }
+
+            Deallocate(std::exchange(data_, data));
+            SetSize(size + 1);
+            return slot;
+        }
+};
+
+template <typename T, typename Alloc>
+    requires std::equality_comparable<T>
+bool operator==(const CompactVector<T, Alloc>& lhs, const CompactVector<T, Alloc>& rhs) {
+    return std::equal(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
+}
+
+template <typename T, typename Alloc>
+    requires std::three_way_comparable<T>
+auto operator<=>(const CompactVector<T, Alloc>& lhs, const CompactVector<T, Alloc>& rhs) {
+    return std::lexicographical_compare_three_way(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
+}
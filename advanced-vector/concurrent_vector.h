@@ -0,0 +1,204 @@
+#pragma once
+
+/**
+ * @file concurrent_vector.h
+ * @brief Definition of the ConcurrentVector class, a vector many threads can append to without a lock.
+ */
+
+#include "vector.h"
+#include "segmented_vector.h"
+
+#include <atomic>
+
+/**
+ * @brief The ConcurrentVector class is an append-only vector for many producer threads.
+ * The elements live in segments of growing size that are never moved, so references stay valid and
+ * EmplaceBack only claims an index with an atomic compare-and-swap. Once the producers are done,
+ * Freeze relocates the elements into a contiguous Vector with a single allocation.
+ *
+ * Size() counts the elements still being constructed. An element can be read by a thread once
+ * the EmplaceBack that added it has returned and the reading thread is synchronized with it,
+ * for example by joining the producer threads. The allocator must be safe to use from several threads.
+ * @tparam FirstSegment The number of elements in the first segment, a power of two, see detail::SegmentLayout.
+ */
+template <typename T, typename Alloc = std::allocator<T>, size_t FirstSegment = 32>
+class ConcurrentVector {
+    using AllocTraits = std::allocator_traits<Alloc>;
+    using Layout = detail::SegmentLayout<FirstSegment>;
+
+    static_assert(std::is_nothrow_move_constructible_v<T>, "Elements are moved into their slots after claiming them, which must not fail");
+
+    public:
+        using allocator_type = Alloc;
+
+        ConcurrentVector() = default;
+
+        /**
+         * @brief Constructs an empty ConcurrentVector using the allocator.
+         * @param alloc The allocator.
+         */
+        explicit ConcurrentVector(const Alloc& alloc) noexcept : alloc_(alloc) {}
+
+        ConcurrentVector(const ConcurrentVector&) = delete;
+        ConcurrentVector& operator=(const ConcurrentVector&) = delete;
+
+        ~ConcurrentVector() {
+            Clear();
+        }
+
+        /**
+         * @brief Constructs a new element at the end, may be called from several threads at once.
+         * The segment of the next index is allocated before the index is claimed, so a failed allocation
+         * or a throwing constructor leaves no gap.
+         * @param args The arguments to forward to the constructor.
+         * @return A reference to the new element, valid until Freeze or Clear.
+         */
+        template <typename... Args>
+        T& EmplaceBack(Args&&... args) {
+            if constexpr (std::is_nothrow_constructible_v<T, Args...>) {
+                T* slot = ClaimSlot();
+                detail::ConstructAt(alloc_, slot, std::forward<Args>(args)...);
+                return *slot;
+            }
+            else {
+                T value(std::forward<Args>(args)...);
+                T* slot = ClaimSlot();
+                detail::ConstructAt(alloc_, slot, std::move(value));
+                return *slot;
+            }
+        }
+
+        template <typename Type>
+        T& PushBack(Type&& value) {
+            return EmplaceBack(std::forward<Type>(value));
+        }
+
+        /**
+         * @brief Allocates the segments for the first capacity elements, may be called from several threads at once.
+         * @param capacity The number of elements to make room for.
+         */
+        void Reserve(size_t capacity) {
+            for (size_t k = 0; SegmentStart(k) < capacity; ++k) {
+                EnsureSegment(k);
+            }
+        }
+
+        const T& operator[](size_t index) const noexcept {
+            return const_cast<ConcurrentVector&>(*this)[index];
+        }
+
+        T& operator[](size_t index) noexcept {
+            assert(index < Size());
+            const size_t k = SegmentOf(index);
+            return segments_[k].load(std::memory_order_acquire)[index - SegmentStart(k)];
+        }
+
+        /**
+         * @brief Gets the number of claimed elements, including the ones being constructed.
+         * @return The number of elements.
+         */
+        size_t Size() const noexcept {
+            return size_.load(std::memory_order_acquire);
+        }
+
+        allocator_type GetAllocator() const noexcept {
+            return alloc_;
+        }
+
+        /**
+         * @brief Relocates the elements into a contiguous Vector with one allocation, leaving the ConcurrentVector empty.
+         * Must not run concurrently with other operations.
+         * @return The Vector holding the elements in index order.
+         */
+        Vector<T, Alloc> Freeze() {
+            const size_t size = Size();
+            Vector<T, Alloc> result(alloc_);
+            if (size == 0) {
+                return result;
+            }
+
+            T* buffer = AllocTraits::allocate(alloc_, size);
+            for (size_t k = 0; SegmentStart(k) < size; ++k) {
+                const size_t count = std::min(SegmentSize(k), size - SegmentStart(k));
+                detail::UninitializedRelocateN(alloc_, segments_[k].load(std::memory_order_relaxed), count, buffer + SegmentStart(k));
+            }
+            size_.store(0, std::memory_order_relaxed);
+            result.Adopt(buffer, size, size);
+
+            FreeSegments();
+            return result;
+        }
+
+        /**
+         * @brief Destroys the elements and releases the segments. Must not run concurrently with other operations.
+         */
+        void Clear() noexcept {
+            const size_t size = Size();
+            for (size_t k = 0; SegmentStart(k) < size; ++k) {
+                const size_t count = std::min(SegmentSize(k), size - SegmentStart(k));
+                detail::DestroyN(alloc_, segments_[k].load(std::memory_order_relaxed), count);
+            }
+            size_.store(0, std::memory_order_relaxed);
+            FreeSegments();
+        }
+
+    private:
+        static constexpr size_t kMaxSegments = Layout::kMaxSegments;
+
+        [[no_unique_address]] Alloc alloc_;             /*< The allocator of the segments. */
+        std::atomic<size_t> size_ = 0;                  /*< The number of claimed elements. */
+        std::atomic<T*> segments_[kMaxSegments] = {};   /*< The segments, allocated on demand. */
+
+        static constexpr size_t SegmentOf(size_t index) noexcept {
+            return Layout::SegmentOf(index);
+        }
+
+        static constexpr size_t SegmentStart(size_t k) noexcept {
+            return Layout::SegmentStart(k);
+        }
+
+        static constexpr size_t SegmentSize(size_t k) noexcept {
+            return Layout::SegmentSize(k);
+        }
+
+        /**
+         * @brief Gets the segment k, allocating it if no thread did yet.
+         * @param k The index of the segment.
+         * @return A pointer to the segment.
+         */
+        T* EnsureSegment(size_t k) {
+            T* segment = segments_[k].load(std::memory_order_acquire);
+            if (segment != nullptr) {
+                return segment;
+            }
+
+            T* fresh = AllocTraits::allocate(alloc_, SegmentSize(k));
+            if (segments_[k].compare_exchange_strong(segment, fresh, std::memory_order_acq_rel, std::memory_order_acquire)) {
+                return fresh;
+            }
+            AllocTraits::deallocate(alloc_, fresh, SegmentSize(k));
+            return segment;
+        }
+
+        /**
+         * @brief Claims the next index, making sure its segment exists first.
+         * @return The address of the claimed slot.
+         */
+        T* ClaimSlot() {
+            size_t index = size_.load(std::memory_order_relaxed);
+            T* slot;
+            do {
+                const size_t k = SegmentOf(index);
+                slot = EnsureSegment(k) + (index - SegmentStart(k));
+            } while (!size_.compare_exchange_weak(index, index + 1, std::memory_order_relaxed));
+            return slot;
+        }
+
+        void FreeSegments() noexcept {
+            for (size_t k = 0; k < kMaxSegments; ++k) {
+                if (T* segment = segments_[k].exchange(nullptr, std::memory_order_relaxed)) {
+                    AllocTraits::deallocate(alloc_, segment, SegmentSize(k));
+                }
+            }
+        }
+};
@@ -0,0 +1,213 @@
+#pragma once
+
+/**
+ * @file cow_vector.h
+ * @brief Definition of the CowVector class, a copy-on-write Vector whose copies share one buffer.
+ */
+
+#include "vector.h"
+
+#include <atomic>
+#include <initializer_list>
+#include <span>
+#include <utility>
+
+/**
+ * @brief The CowVector class shares the elements of a Vector between its copies through an atomic reference count.
+ * Copying a CowVector only bumps the count, and the first mutation through a shared copy materializes
+ * a private Vector with the elements. A unique CowVector mutates its Vector in place.
+ *
+ * As with std::shared_ptr, different CowVector objects sharing a buffer may be read, copied, mutated
+ * and destroyed from different threads. A single CowVector must not be mutated while another thread uses it.
+ * The mutating members invalidate the spans and references obtained before, since they may detach the buffer.
+ */
+template <typename T, typename Alloc = std::allocator<T>>
+class CowVector {
+    using AllocTraits = std::allocator_traits<Alloc>;
+
+    public:
+        using value_type = T;
+        using allocator_type = Alloc;
+        using vector_type = Vector<T, Alloc>;
+        using const_iterator = const T*;
+
+        CowVector() = default;
+
+        /**
+         * @brief Constructs an empty CowVector using the allocator.
+         * @param alloc The allocator.
+         */
+        explicit CowVector(const Alloc& alloc) noexcept : alloc_(alloc) {}
+
+        /**
+         * @brief Takes over the elements of a Vector without copying them.
+         * @param elements The Vector to take the elements from.
+         */
+        explicit CowVector(vector_type&& elements) : alloc_(elements.GetAllocator()) {
+            if (elements.Size() != 0) {
+                shared_ = MakeShared(std::move(elements));
+            }
+        }
+
+        CowVector(std::initializer_list<T> init, const Alloc& alloc = Alloc()) : CowVector(vector_type(init.begin(), init.end(), alloc)) {}
+
+        /**
+         * @brief Copy constructor. Shares the elements of the other CowVector in O(1).
+         * @param other The CowVector to share the elements of.
+         */
+        CowVector(const CowVector& other) noexcept : alloc_(other.alloc_), shared_(other.shared_) {
+            if (shared_ != nullptr) {
+                shared_->refs.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+
+        CowVector(CowVector&& other) noexcept : alloc_(other.alloc_), shared_(std::exchange(other.shared_, nullptr)) {}
+
+        ~CowVector() {
+            Release();
+        }
+
+        CowVector& operator=(const CowVector& other) noexcept {
+            if (shared_ != other.shared_) {
+                CowVector copy(other);
+                Swap(copy);
+            }
+            return *this;
+        }
+
+        CowVector& operator=(CowVector&& other) noexcept {
+            if (this != &other) {
+                Release();
+                alloc_ = other.alloc_;
+                shared_ = std::exchange(other.shared_, nullptr);
+            }
+            return *this;
+        }
+
+        const_iterator begin() const noexcept {
+            return shared_ != nullptr ? shared_->elements.begin() : nullptr;
+        }
+
+        const_iterator end() const noexcept {
+            return shared_ != nullptr ? shared_->elements.end() : nullptr;
+        }
+
+        size_t Size() const noexcept {
+            return shared_ != nullptr ? shared_->elements.Size() : 0;
+        }
+
+        const T& operator[](size_t index) const noexcept {
+            assert(index < Size());
+            return shared_->elements[index];
+        }
+
+        /**
+         * @brief Gets a read-only view of the elements, valid until this CowVector is mutated or destroyed.
+         * @return A span over the elements.
+         */
+        std::span<const T> View() const noexcept {
+            return {begin(), Size()};
+        }
+
+        /**
+         * @brief Gets the number of CowVector objects sharing the elements.
+         * @return The number of owners, 0 for an empty CowVector without a buffer.
+         */
+        size_t UseCount() const noexcept {
+            return shared_ != nullptr ? shared_->refs.load(std::memory_order_acquire) : 0;
+        }
+
+        allocator_type GetAllocator() const noexcept {
+            return alloc_;
+        }
+
+        /**
+         * @brief Gets the Vector for mutation, copying the elements first if they are shared.
+         * The elements are left shared if the copy throws.
+         * @return The private Vector holding the elements.
+         */
+        vector_type& Mutate() {
+            if (shared_ == nullptr) {
+                shared_ = MakeShared(vector_type(alloc_));
+            }
+            else if (shared_->refs.load(std::memory_order_acquire) != 1) {
+                Shared* fresh = MakeShared(vector_type(shared_->elements, alloc_));
+                Release();
+                shared_ = fresh;
+            }
+            return shared_->elements;
+        }
+
+        template <typename... Args>
+        T& EmplaceBack(Args&&... args) {
+            return Mutate().EmplaceBack(std::forward<Args>(args)...);
+        }
+
+        template <typename Type>
+        void PushBack(Type&& value) {
+            EmplaceBack(std::forward<Type>(value));
+        }
+
+        void PopBack() {
+            Mutate().PopBack();
+        }
+
+        void Resize(size_t new_size) {
+            Mutate().Resize(new_size);
+        }
+
+        /**
+         * @brief Removes all elements. A shared buffer is only released, without copying it.
+         */
+        void Clear() noexcept {
+            if (shared_ != nullptr && shared_->refs.load(std::memory_order_acquire) == 1) {
+                shared_->elements.Clear();
+            }
+            else {
+                Release();
+            }
+        }
+
+        void Swap(CowVector& other) noexcept {
+            std::swap(alloc_, other.alloc_);
+            std::swap(shared_, other.shared_);
+        }
+
+        friend bool operator==(const CowVector& lhs, const CowVector& rhs) {
+            return lhs.shared_ == rhs.shared_ || std::ranges::equal(lhs.View(), rhs.View());
+        }
+
+    private:
+        /**
+         * @brief The block shared by the copies, allocated with the rebound allocator.
+         */
+        struct Shared {
+            std::atomic<size_t> refs;   /*< The number of CowVector objects sharing the block. */
+            vector_type elements;       /*< The shared elements. */
+        };
+
+        using SharedAlloc = typename AllocTraits::template rebind_alloc<Shared>;
+        using SharedTraits = std::allocator_traits<SharedAlloc>;
+
+        [[no_unique_address]] Alloc alloc_;     /*< The allocator of the elements. */
+        Shared* shared_ = nullptr;              /*< The shared block, nullptr while empty. */
+
+        Shared* MakeShared(vector_type&& elements) {
+            SharedAlloc alloc(alloc_);
+            Shared* shared = SharedTraits::allocate(alloc, 1);
+            ::new (static_cast<void*>(shared)) Shared{1, std::move(elements)};
+            return shared;
+        }
+
+        /**
+         * @brief Drops the reference to the shared block, destroying it if this was the last owner.
+         */
+        void Release() noexcept {
+            Shared* shared = std::exchange(shared_, nullptr);
+            if (shared != nullptr && shared->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                SharedAlloc alloc(alloc_);
+                shared->~Shared();
+                SharedTraits::deallocate(alloc, shared, 1);
+            }
+        }
+};
@@ -0,0 +1,757 @@
+#pragma once
+
+/**
+ * @file flat_map.h
+ * @brief Definition of the FlatSet and FlatMap classes, sorted associative containers stored in Vectors.
+ */
+
+#include "vector.h"
+
+#include <compare>
+#include <functional>
+#include <stdexcept>
+#include <utility>
+
+/**
+ * @brief Tells a FlatSet or FlatMap constructor that the range is already sorted and free of duplicate keys.
+ */
+struct SortedUniqueTag {
+    explicit SortedUniqueTag() = default;
+};
+
+inline constexpr SortedUniqueTag SortedUnique{};
+
+namespace detail {
+
+/*< Whether the comparator accepts keys of other types than the key type. */
+template <typename Compare>
+inline constexpr bool kTransparent = requires { typename Compare::is_transparent; };
+
+/**
+ * @brief Tells whether a key of type Key can look up keys of type K: it is a K, the comparator is transparent
+ * or the lookup converts it to K.
+ */
+template <typename Compare, typename Key, typename K>
+concept LookupKey = std::same_as<Key, K> || kTransparent<Compare> || std::constructible_from<K, const Key&>;
+
+/**
+ * @brief Passes a lookup key through if the comparator accepts it and converts it to K otherwise,
+ * so a search converts the key once instead of at every comparison.
+ */
+template <typename K, typename Compare, typename Key>
+decltype(auto) ToLookupKey(const Key& key) {
+    if constexpr (std::same_as<Key, K> || kTransparent<Compare>) {
+        return (key);
+    }
+    else {
+        return K(key);
+    }
+}
+
+/**
+ * @brief Finds the first element not ordered before the key with a binary search whose loop has no branch
+ * depending on the data: every step halves the range with a conditional move, so mispredictions do not
+ * stall the search and the number of steps only depends on the size.
+ * @param data The sorted elements.
+ * @param n The number of elements.
+ * @param key The key.
+ * @param comp The ordering.
+ * @return The index of the first element not ordered before the key, n if there is none.
+ */
+template <typename T, typename Key, typename Compare>
+size_t BranchlessLowerBound(const T* data, size_t n, const Key& key, const Compare& comp) {
+    if (n == 0) {
+        return 0;
+    }
+    const T* base = data;
+    while (n > 1) {
+        const size_t half = n / 2;
+        base = comp(base[half], key) ? base + half : base;
+        n -= half;
+    }
+    return (base - data) + comp(*base, key);
+}
+
+/**
+ * @brief Finds the first element ordered after the key, see BranchlessLowerBound.
+ */
+template <typename T, typename Key, typename Compare>
+size_t BranchlessUpperBound(const T* data, size_t n, const Key& key, const Compare& comp) {
+    if (n == 0) {
+        return 0;
+    }
+    const T* base = data;
+    while (n > 1) {
+        const size_t half = n / 2;
+        base = !comp(key, base[half]) ? base + half : base;
+        n -= half;
+    }
+    return (base - data) + !comp(key, *base);
+}
+
+}  // namespace detail
+
+/**
+ * @brief The FlatSet class is a sorted set stored in a single Vector.
+ * Lookups are branchless binary searches over contiguous keys, which touch a few cache lines and
+ * allocate nothing, insertions and erasures shift the following keys like Vector::Insert and Vector::Erase.
+ * It suits tables that are built once or in bulk and looked up often.
+ * @tparam Compare The strict weak ordering of the keys, lookups accept other key types if it is transparent.
+ */
+template <typename K, typename Compare = std::less<K>, typename Alloc = std::allocator<K>>
+class FlatSet {
+    public:
+        using container_type = Vector<K, Alloc>;
+        using iterator = const K*;
+        using const_iterator = const K*;
+
+        FlatSet() = default;
+
+        explicit FlatSet(const Compare& comp, const Alloc& alloc = Alloc()) : keys_(alloc), comp_(comp) {}
+
+        /**
+         * @brief Constructs a FlatSet from an unsorted range, sorting it once. Of equal keys the first one is kept.
+         * @param first The iterator to the first key.
+         * @param last The iterator past the last key.
+         * @param comp The ordering.
+         */
+        template <std::input_iterator InputIt>
+        FlatSet(InputIt first, InputIt last, const Compare& comp = Compare()) : keys_(first, last), comp_(comp) {
+            std::stable_sort(keys_.begin(), keys_.end(), comp_);
+            RemoveDuplicates();
+        }
+
+        /**
+         * @brief Constructs a FlatSet from a range that is already sorted and free of duplicates.
+         * @param first The iterator to the first key.
+         * @param last The iterator past the last key.
+         * @param comp The ordering.
+         */
+        template <std::input_iterator InputIt>
+        FlatSet(SortedUniqueTag, InputIt first, InputIt last, const Compare& comp = Compare()) : keys_(first, last), comp_(comp) {
+            assert(std::adjacent_find(keys_.begin(), keys_.end(), std::not_fn(comp_)) == keys_.end());
+        }
+
+        FlatSet(std::initializer_list<K> keys, const Compare& comp = Compare()) : FlatSet(keys.begin(), keys.end(), comp) {}
+
+        const_iterator begin() const noexcept {
+            return keys_.begin();
+        }
+
+        const_iterator end() const noexcept {
+            return keys_.end();
+        }
+
+        size_t Size() const noexcept {
+            return keys_.Size();
+        }
+
+        size_t Capacity() const noexcept {
+            return keys_.Capacity();
+        }
+
+        /**
+         * @brief Gets the sorted keys.
+         * @return The Vector holding the keys.
+         */
+        const container_type& Keys() const noexcept {
+            return keys_;
+        }
+
+        void Reserve(size_t capacity) {
+            keys_.Reserve(capacity);
+        }
+
+        void ShrinkToFit() {
+            keys_.ShrinkToFit();
+        }
+
+        void Clear() noexcept {
+            keys_.Clear();
+        }
+
+        template <typename Key = K>
+            requires detail::LookupKey<Compare, Key, K>
+        const_iterator LowerBound(const Key& key) const {
+            return keys_.begin() + detail::BranchlessLowerBound(keys_.begin(), keys_.Size(), detail::ToLookupKey<K, Compare>(key), comp_);
+        }
+
+        template <typename Key = K>
+            requires detail::LookupKey<Compare, Key, K>
+        const_iterator UpperBound(const Key& key) const {
+            return keys_.begin() + detail::BranchlessUpperBound(keys_.begin(), keys_.Size(), detail::ToLookupKey<K, Compare>(key), comp_);
+        }
+
+        /**
+         * @brief Finds a key.
+         * @param key The key to look for.
+         * @return An iterator pointing to the key, end() if the FlatSet does not hold it.
+         */
+        template <typename Key = K>
+            requires detail::LookupKey<Compare, Key, K>
+        const_iterator Find(const Key& key) const {
+            const auto& lookup = detail::ToLookupKey<K, Compare>(key);
+            const const_iterator pos = LowerBound(lookup);
+            return pos != end() && !comp_(lookup, *pos) ? pos : end();
+        }
+
+        template <typename Key = K>
+            requires detail::LookupKey<Compare, Key, K>
+        bool Contains(const Key& key) const {
+            return Find(key) != end();
+        }
+
+        /**
+         * @brief Inserts a key unless an equal one is present.
+         * @param key The key to insert.
+         * @return An iterator pointing to the key in the FlatSet and whether it was inserted.
+         */
+        std::pair<iterator, bool> Insert(const K& key) {
+            return InsertKey(key);
+        }
+
+        std::pair<iterator, bool> Insert(K&& key) {
+            return InsertKey(std::move(key));
+        }
+
+        /**
+         * @brief Inserts the keys of an unsorted range that are not present yet.
+         * The new keys are sorted on their own and merged in with a single pass, see Vector::MergeInsert.
+         * @param first The iterator to the first key.
+         * @param last The iterator past the last key.
+         */
+        template <std::input_iterator InputIt>
+        void Insert(InputIt first, InputIt last) {
+            FlatSet incoming(first, last, comp_);
+            incoming.keys_.Erase(std::remove_if(incoming.keys_.begin(), incoming.keys_.end(), [this](const K& key) {
+                return Contains(key);
+            }), incoming.keys_.end());
+            keys_.MergeInsert(std::make_move_iterator(incoming.keys_.begin()), std::make_move_iterator(incoming.keys_.end()), comp_);
+        }
+
+        /**
+         * @brief Erases a key.
+         * @param key The key to erase.
+         * @return The number of erased keys, 0 or 1.
+         */
+        template <typename Key = K>
+            requires detail::LookupKey<Compare, Key, K>
+        size_t Erase(const Key& key) {
+            const const_iterator pos = Find(key);
+            if (pos == end()) {
+                return 0;
+            }
+            keys_.Erase(pos);
+            return 1;
+        }
+
+        iterator Erase(const_iterator pos) {
+            return keys_.Erase(pos);
+        }
+
+        void Swap(FlatSet& other) noexcept {
+            keys_.Swap(other.keys_);
+            std::swap(comp_, other.comp_);
+        }
+
+        friend bool operator==(const FlatSet& lhs, const FlatSet& rhs) {
+            return lhs.keys_ == rhs.keys_;
+        }
+
+    private:
+        container_type keys_;                   /*< The sorted keys. */
+        [[no_unique_address]] Compare comp_;    /*< The ordering of the keys. */
+
+        template <typename Key>
+        std::pair<iterator, bool> InsertKey(Key&& key) {
+            const const_iterator pos = LowerBound(key);
+            if (pos != end() && !comp_(key, *pos)) {
+                return {pos, false};
+            }
+            return {keys_.Insert(pos, std::forward<Key>(key)), true};
+        }
+
+        /**
+         * @brief Removes the sorted keys equal to their predecessor.
+         */
+        void RemoveDuplicates() {
+            const auto equal = [this](const K& lhs, const K& rhs) {
+                return !comp_(lhs, rhs);
+            };
+            keys_.Erase(std::unique(keys_.begin(), keys_.end(), equal), keys_.end());
+        }
+};
+
+/**
+ * @brief The FlatMap class is a sorted map keeping the keys and the values in two Vectors.
+ * A lookup scans only the contiguous keys with a branchless binary search and touches the value it finds,
+ * so large values do not dilute the cache lines of the search. Insertions and erasures shift the following
+ * keys and values like Vector::Insert and Vector::Erase. The elements are visited as pairs of references.
+ * @tparam Compare The strict weak ordering of the keys, lookups accept other key types if it is transparent.
+ */
+template <typename K, typename V, typename Compare = std::less<K>, typename KeyAlloc = std::allocator<K>, typename ValueAlloc = std::allocator<V>>
+class FlatMap {
+    template <bool Const>
+    class Iterator;
+
+    public:
+        using key_container_type = Vector<K, KeyAlloc>;
+        using mapped_container_type = Vector<V, ValueAlloc>;
+        using value_type = std::pair<K, V>;
+        using reference = std::pair<const K&, V&>;
+        using const_reference = std::pair<const K&, const V&>;
+        using iterator = Iterator<false>;
+        using const_iterator = Iterator<true>;
+
+        FlatMap() = default;
+
+        explicit FlatMap(const Compare& comp) : comp_(comp) {}
+
+        /**
+         * @brief Constructs a FlatMap from an unsorted range of key-value pairs, sorting it once.
+         * Of pairs with equal keys the first one is kept.
+         * @param first The iterator to the first pair.
+         * @param last The iterator past the last pair.
+         * @param comp The ordering.
+         */
+        template <std::input_iterator InputIt>
+        FlatMap(InputIt first, InputIt last, const Compare& comp = Compare()) : comp_(comp) {
+            Vector<value_type> pairs(first, last);
+            std::stable_sort(pairs.begin(), pairs.end(), [this](const value_type& lhs, const value_type& rhs) {
+                return comp_(lhs.first, rhs.first);
+            });
+            const auto equal = [this](const value_type& lhs, const value_type& rhs) {
+                return !comp_(lhs.first, rhs.first);
+            };
+            pairs.Erase(std::unique(pairs.begin(), pairs.end(), equal), pairs.end());
+            Split(pairs);
+        }
+
+        /**
+         * @brief Constructs a FlatMap from ranges of keys and values, the keys already sorted and free of duplicates.
+         * @param keys The sorted keys.
+         * @param values The values in the order of the keys.
+         * @param comp The ordering.
+         */
+        FlatMap(SortedUniqueTag, key_container_type keys, mapped_container_type values, const Compare& comp = Compare())
+            : keys_(std::move(keys)), values_(std::move(values)), comp_(comp) {
+            assert(keys_.Size() == values_.Size());
+            assert(std::adjacent_find(keys_.begin(), keys_.end(), std::not_fn(comp_)) == keys_.end());
+        }
+
+        FlatMap(std::initializer_list<value_type> pairs, const Compare& comp = Compare()) : FlatMap(pairs.begin(), pairs.end(), comp) {}
+
+        iterator begin() noexcept {
+            return {this, 0};
+        }
+
+        iterator end() noexcept {
+            return {this, Size()};
+        }
+
+        const_iterator begin() const noexcept {
+            return {this, 0};
+        }
+
+        const_iterator end() const noexcept {
+            return {this, Size()};
+        }
+
+        const_iterator cbegin() const noexcept {
+            return begin();
+        }
+
+        const_iterator cend() const noexcept {
+            return end();
+        }
+
+        size_t Size() const noexcept {
+            return keys_.Size();
+        }
+
+        /**
+         * @brief Gets the sorted keys.
+         * @return The Vector holding the keys.
+         */
+        const key_container_type& Keys() const noexcept {
+            return keys_;
+        }
+
+        /**
+         * @brief Gets the values in the order of their keys.
+         * @return The Vector holding the values.
+         */
+        const mapped_container_type& Values() const noexcept {
+            return values_;
+        }
+
+        void Reserve(size_t capacity) {
+            keys_.Reserve(capacity);
+            values_.Reserve(capacity);
+        }
+
+        void ShrinkToFit() {
+            keys_.ShrinkToFit();
+            values_.ShrinkToFit();
+        }
+
+        void Clear() noexcept {
+            keys_.Clear();
+            values_.Clear();
+        }
+
+        template <typename Key = K>
+            requires detail::LookupKey<Compare, Key, K>
+        iterator LowerBound(const Key& key) {
+            return {this, detail::BranchlessLowerBound(keys_.begin(), keys_.Size(), detail::ToLookupKey<K, Compare>(key), comp_)};
+        }
+
+        template <typename Key = K>
+            requires detail::LookupKey<Compare, Key, K>
+        const_iterator LowerBound(const Key& key) const {
+            return const_cast<FlatMap&>(*this).LowerBound(key);
+        }
+
+        template <typename Key = K>
+            requires detail::LookupKey<Compare, Key, K>
+        iterator UpperBound(const Key& key) {
+            return {this, detail::BranchlessUpperBound(keys_.begin(), keys_.Size(), detail::ToLookupKey<K, Compare>(key), comp_)};
+        }
+
+        template <typename Key = K>
+            requires detail::LookupKey<Compare, Key, K>
+        const_iterator UpperBound(const Key& key) const {
+            return const_cast<FlatMap&>(*this).UpperBound(key);
+        }
+
+        /**
+         * @brief Finds a key.
+         * @param key The key to look for.
+         * @return An iterator pointing to the element, end() if the FlatMap does not hold the key.
+         */
+        template <typename Key = K>
+            requires detail::LookupKey<Compare, Key, K>
+        iterator Find(const Key& key) {
+            const size_t index = FindIndex(key);
+            return {this, index};
+        }
+
+        template <typename Key = K>
+            requires detail::LookupKey<Compare, Key, K>
+        const_iterator Find(const Key& key) const {
+            return const_cast<FlatMap&>(*this).Find(key);
+        }
+
+        template <typename Key = K>
+            requires detail::LookupKey<Compare, Key, K>
+        bool Contains(const Key& key) const {
+            return FindIndex(key) != Size();
+        }
+
+        /**
+         * @brief Gets the value of a key, throws std::out_of_range if the FlatMap does not hold it.
+         * @param key The key.
+         * @return A reference to the value.
+         */
+        template <typename Key = K>
+            requires detail::LookupKey<Compare, Key, K>
+        V& At(const Key& key) {
+            const size_t index = FindIndex(key);
+            if (index == Size()) {
+                throw std::out_of_range("FlatMap::At: no such key");
+            }
+            return values_[index];
+        }
+
+        template <typename Key = K>
+            requires detail::LookupKey<Compare, Key, K>
+        const V& At(const Key& key) const {
+            return const_cast<FlatMap&>(*this).At(key);
+        }
+
+        /**
+         * @brief Gets the value of a key, inserting a value-initialized one if the FlatMap does not hold it.
+         * @param key The key.
+         * @return A reference to the value.
+         */
+        V& operator[](const K& key) {
+            return (*TryEmplace(key).first).second;
+        }
+
+        V& operator[](K&& key) {
+            return (*TryEmplace(std::move(key)).first).second;
+        }
+
+        /**
+         * @brief Inserts a key with a value constructed from args unless the key is present, in which case
+         * args are left untouched. Gives the strong guarantee if the keys and values move without throwing,
+         * the basic one otherwise.
+         * @param key The key.
+         * @param args The arguments to construct the value from.
+         * @return An iterator pointing to the element with the key and whether it was inserted.
+         */
+        template <typename... Args>
+        std::pair<iterator, bool> TryEmplace(const K& key, Args&&... args) {
+            return EmplaceKey(key, std::forward<Args>(args)...);
+        }
+
+        template <typename... Args>
+        std::pair<iterator, bool> TryEmplace(K&& key, Args&&... args) {
+            return EmplaceKey(std::move(key), std::forward<Args>(args)...);
+        }
+
+        /**
+         * @brief Inserts a key-value pair unless the key is present.
+         * @param pair The pair to insert.
+         * @return An iterator pointing to the element with the key and whether it was inserted.
+         */
+        std::pair<iterator, bool> Insert(const value_type& pair) {
+            return TryEmplace(pair.first, pair.second);
+        }
+
+        std::pair<iterator, bool> Insert(value_type&& pair) {
+            return TryEmplace(std::move(pair.first), std::move(pair.second));
+        }
+
+        /**
+         * @brief Inserts a key with a value or assigns the value if the key is present.
+         * @param key The key.
+         * @param value The value.
+         * @return An iterator pointing to the element with the key and whether it was inserted.
+         */
+        template <typename Value>
+        std::pair<iterator, bool> InsertOrAssign(const K& key, Value&& value) {
+            auto result = TryEmplace(key, std::forward<Value>(value));
+            if (!result.second) {
+                values_[result.first.index_] = std::forward<Value>(value);
+            }
+            return result;
+        }
+
+        /**
+         * @brief Inserts the pairs of an unsorted range whose keys are not present yet.
+         * The new pairs are sorted on their own and merged with the current elements in a single pass
+         * into new Vectors, so the FlatMap is unchanged if an exception is thrown. The current elements
+         * are moved if that can not throw and copied otherwise.
+         * @param first The iterator to the first pair.
+         * @param last The iterator past the last pair.
+         */
+        template <std::input_iterator InputIt>
+        void Insert(InputIt first, InputIt last) {
+            FlatMap incoming(first, last, comp_);
+            key_container_type keys(keys_.GetAllocator());
+            mapped_container_type values(values_.GetAllocator());
+            keys.Reserve(Size() + incoming.Size());
+            values.Reserve(Size() + incoming.Size());
+
+            constexpr bool kMoveCurrent = std::is_nothrow_move_constructible_v<K> && std::is_nothrow_move_constructible_v<V>;
+            size_t i = 0;
+            size_t j = 0;
+            const auto take_current = [&] {
+                if constexpr (kMoveCurrent) {
+                    keys.PushBack(std::move(keys_[i]));
+                    values.PushBack(std::move(values_[i]));
+                }
+                else {
+                    keys.PushBack(keys_[i]);
+                    values.PushBack(values_[i]);
+                }
+                ++i;
+            };
+            const auto take_incoming = [&] {
+                keys.PushBack(std::move(incoming.keys_[j]));
+                values.PushBack(std::move(incoming.values_[j]));
+                ++j;
+            };
+
+            while (i < Size() && j < incoming.Size()) {
+                if (comp_(incoming.keys_[j], keys_[i])) {
+                    take_incoming();
+                }
+                else {
+                    if (!comp_(keys_[i], incoming.keys_[j])) {
+                        ++j;  // the key is present, the current value wins
+                    }
+                    take_current();
+                }
+            }
+            while (i < Size()) {
+                take_current();
+            }
+            while (j < incoming.Size()) {
+                take_incoming();
+            }
+            keys_.Swap(keys);
+            values_.Swap(values);
+        }
+
+        /**
+         * @brief Erases the element with a key.
+         * @param key The key to erase.
+         * @return The number of erased elements, 0 or 1.
+         */
+        template <typename Key = K>
+            requires detail::LookupKey<Compare, Key, K>
+        size_t Erase(const Key& key) {
+            const size_t index = FindIndex(key);
+            if (index == Size()) {
+                return 0;
+            }
+            EraseAt(index);
+            return 1;
+        }
+
+        iterator Erase(const_iterator pos) {
+            assert(pos.index_ < Size());
+            EraseAt(pos.index_);
+            return {this, pos.index_};
+        }
+
+        void Swap(FlatMap& other) noexcept {
+            keys_.Swap(other.keys_);
+            values_.Swap(other.values_);
+            std::swap(comp_, other.comp_);
+        }
+
+    private:
+        key_container_type keys_;               /*< The sorted keys. */
+        mapped_container_type values_;          /*< The values, values_[i] belongs to keys_[i]. */
+        [[no_unique_address]] Compare comp_;    /*< The ordering of the keys. */
+
+        template <typename Key, typename... Args>
+        std::pair<iterator, bool> EmplaceKey(Key&& key, Args&&... args) {
+            const size_t index = detail::BranchlessLowerBound(keys_.begin(), keys_.Size(), key, comp_);
+            if (index != Size() && !comp_(key, keys_[index])) {
+                return {{this, index}, false};
+            }
+            keys_.Emplace(keys_.begin() + index, std::forward<Key>(key));
+            try {
+                values_.Emplace(values_.begin() + index, std::forward<Args>(args)...);
+            }
+            catch (...) {
+                keys_.Erase(keys_.begin() + index);
+                throw;
+            }
+            return {{this, index}, true};
+        }
+
+        template <typename Key>
+        size_t FindIndex(const Key& key) const {
+            const auto& lookup = detail::ToLookupKey<K, Compare>(key);
+            const size_t index = detail::BranchlessLowerBound(keys_.begin(), keys_.Size(), lookup, comp_);
+            return index != Size() && !comp_(lookup, keys_[index]) ? index : Size();
+        }
+
+        void EraseAt(size_t index) {
+            keys_.Erase(keys_.begin() + index);
+            values_.Erase(values_.begin() + index);
+        }
+
+        /**
+         * @brief Moves sorted unique pairs into the key and value Vectors.
+         */
+        void Split(Vector<value_type>& pairs) {
+            keys_.Reserve(pairs.Size());
+            values_.Reserve(pairs.Size());
+            for (value_type& pair : pairs) {
+                keys_.PushBack(std::move(pair.first));
+                values_.PushBack(std::move(pair.second));
+            }
+        }
+};
+
+/**
+ * @brief A random-access iterator over the elements of a FlatMap, dereferences to a pair of references.
+ */
+template <typename K, typename V, typename Compare, typename KeyAlloc, typename ValueAlloc>
+template <bool Const>
+class FlatMap<K, V, Compare, KeyAlloc, ValueAlloc>::Iterator {
+    using Owner = std::conditional_t<Const, const FlatMap, FlatMap>;
+
+    public:
+        using iterator_concept = std::random_access_iterator_tag;
+        using iterator_category = std::input_iterator_tag;
+        using value_type = FlatMap::value_type;
+        using difference_type = std::ptrdiff_t;
+        using reference = std::conditional_t<Const, FlatMap::const_reference, FlatMap::reference>;
+        using pointer = void;
+
+        Iterator() = default;
+
+        Iterator(Owner* owner, size_t index) noexcept : owner_(owner), index_(index) {}
+
+        template <bool OtherConst>
+            requires (Const && !OtherConst)
+        Iterator(const Iterator<OtherConst>& other) noexcept : owner_(other.owner_), index_(other.index_) {}
+
+        reference operator*() const noexcept {
+            return {owner_->keys_[index_], owner_->values_[index_]};
+        }
+
+        reference operator[](difference_type n) const noexcept {
+            return *(*this + n);
+        }
+
+        Iterator& operator++() noexcept {
+            ++index_;
+            return *this;
+        }
+
+        Iterator operator++(int) noexcept {
+            Iterator copy = *this;
+            ++index_;
+            return copy;
+        }
+
+        Iterator& operator--() noexcept {
+            --index_;
+            return *this;
+        }
+
+        Iterator operator--(int) noexcept {
+            Iterator copy = *this;
+            --index_;
+            return copy;
+        }
+
+        Iterator& operator+=(difference_type n) noexcept {
+            index_ += n;
+            return *this;
+        }
+
+        Iterator& operator-=(difference_type n) noexcept {
+            index_ -= n;
+            return *this;
+        }
+
+        friend Iterator operator+(Iterator it, difference_type n) noexcept {
+            return it += n;
+        }
+
+        friend Iterator operator+(difference_type n, Iterator it) noexcept {
+            return it += n;
+        }
+
+        friend Iterator operator-(Iterator it, difference_type n) noexcept {
+            return it -= n;
+        }
+
+        friend difference_type operator-(const Iterator& lhs, const Iterator& rhs) noexcept {
+            return static_cast<difference_type>(lhs.index_) - static_cast<difference_type>(rhs.index_);
+        }
+
+        friend bool operator==(const Iterator& lhs, const Iterator& rhs) noexcept {
+            return lhs.index_ == rhs.index_;
+        }
+
+        friend auto operator<=>(const Iterator& lhs, const Iterator& rhs) noexcept {
+            return lhs.index_ <=> rhs.index_;
+        }
+
+    private:
+        friend class FlatMap;
+        friend class Iterator<!Const>;
+
+        Owner* owner_ = nullptr;    /*< The FlatMap. */
+        size_t index_ = 0;          /*< The index of the element. */
+};
@@ -1,8 +1,35 @@
+// The tests check the instrumentation counters as well
+#define ADVANCED_VECTOR_STATS
 #include "vector.h"
+#include "allocators.h"
+#include "small_vector.h"
+#include "mapped_vector.h"
+#include "serialization.h"
+#include "concurrent_vector.h"
+#include "batch_appender.h"
+#include "segmented_vector.h"
+#include "soa_vector.h"
+#include "simd_algorithms.h"
+#include "flat_map.h"
+#include "cow_vector.h"
+#include "persistent_vector.h"
+#include "compact_vector.h"
+#include "bit_vector.h"
 
+#include <array>
+#include <atomic>
+#include <cstring>
+#include <fcntl.h>
+#include <filesystem>
 #include <iostream>
+#include <list>
+#include <memory_resource>
+#include <numeric>
+#include <random>
+#include <sstream>
 #include <stdexcept>
 #include <string>
+#include <thread>
 
 namespace {
 
@@ -98,8 +125,149 @@ struct Obj {
     static inline int num_destroyed = 0;
 };
 
+template <typename T, bool Propagate>
+struct TrackingAllocator {
+    using value_type = T;
+    using propagate_on_container_copy_assignment = std::bool_constant<Propagate>;
+    using propagate_on_container_move_assignment = std::bool_constant<Propagate>;
+    using propagate_on_container_swap = std::bool_constant<Propagate>;
+    using is_always_equal = std::false_type;
+
+    explicit TrackingAllocator(int id)
+        : id(id)  //
+    {
+    }
+
+    template <typename U>
+    TrackingAllocator(const TrackingAllocator<U, Propagate>& other) noexcept
+        : id(other.id)  //
+    {
+    }
+
+    T* allocate(size_t n) {
+        ++num_allocations;
+        return std::allocator<T>{}.allocate(n);
+    }
+
+    void deallocate(T* p, size_t n) noexcept {
+        ++num_deallocations;
+        std::allocator<T>{}.deallocate(p, n);
+    }
+
+    friend bool operator==(const TrackingAllocator& lhs, const TrackingAllocator& rhs) noexcept {
+        return lhs.id == rhs.id;
+    }
+
+    static void ResetCounters() {
+        num_allocations = 0;
+        num_deallocations = 0;
+    }
+
+    int id = 0;
+
+    static inline int num_allocations = 0;
+    static inline int num_deallocations = 0;
+};
+
+struct RelocatableObj {
+    explicit RelocatableObj(int id)
+        : id(id)  //
+    {
+    }
+
+    RelocatableObj(RelocatableObj&& other) noexcept
+        : id(other.id)  //
+    {
+        ++num_moved;
+    }
+
+    RelocatableObj& operator=(RelocatableObj&& other) = default;
+
+    ~RelocatableObj() {
+        ++num_destroyed;
+    }
+
+    static void ResetCounters() {
+        num_moved = 0;
+        num_destroyed = 0;
+    }
+
+    int id = 0;
+
+    static inline int num_moved = 0;
+    static inline int num_destroyed = 0;
+};
+
+// Counts live objects atomically, so it can be constructed by several threads at once
+struct ParallelObj {
+    ParallelObj() noexcept {
+        ++num_alive;
+    }
+
+    ParallelObj(const ParallelObj& other)
+        : id(other.id)  //
+    {
+        if (other.throw_on_copy) {
+            throw std::runtime_error("Oops");
+        }
+        ++num_alive;
+    }
+
+    ParallelObj& operator=(const ParallelObj& other) = default;
+
+    ~ParallelObj() {
+        --num_alive;
+    }
+
+    int id = 0;
+    bool throw_on_copy = false;
+
+    static inline std::atomic<int> num_alive = 0;
+};
+
+// Relocated with memcpy, while its copy constructor can throw and its move constructor is not noexcept
+struct ThrowingRelocatableObj {
+    explicit ThrowingRelocatableObj(int id)
+        : id(id)  //
+    {
+        ++num_alive;
+    }
+
+    ThrowingRelocatableObj(const ThrowingRelocatableObj& other)
+        : id(other.id)  //
+    {
+        if (other.throw_on_copy) {
+            throw std::runtime_error("Oops");
+        }
+        ++num_alive;
+    }
+
+    ThrowingRelocatableObj(ThrowingRelocatableObj&& other)
+        : id(other.id)  //
+    {
+        ++num_alive;
+    }
+
+    ThrowingRelocatableObj& operator=(const ThrowingRelocatableObj& other) = default;
+
+    ~ThrowingRelocatableObj() {
+        --num_alive;
+    }
+
+    int id = 0;
+    bool throw_on_copy = false;
+
+    static inline int num_alive = 0;
+};
+
 }  // namespace
 
+template <>
+struct IsTriviallyRelocatable<RelocatableObj> : std::true_type {};
+
+template <>
+struct IsTriviallyRelocatable<ThrowingRelocatableObj> : std::true_type {};
+
 void Test1() {
     Obj::ResetCounters();
     const size_t SIZE = 100500;
@@ -380,6 +548,2127 @@ void Test5() {
     }
 }
 
+void Test6() {
+    const size_t SIZE = 100;
+    using namespace std::literals;
+    {
+        std::pmr::monotonic_buffer_resource arena;
+        Vector<std::pmr::string, std::pmr::polymorphic_allocator<std::pmr::string>> v(&arena);
+        v.EmplaceBack("a string long enough to need a heap allocation"s);
+        v.Resize(SIZE);
+        assert(v.GetAllocator().resource() == &arena);
+        assert(v[0].get_allocator().resource() == &arena);
+        assert(v[0] == "a string long enough to need a heap allocation"sv);
+
+        auto v_copy(v);
+        assert(v_copy.GetAllocator().resource() == std::pmr::get_default_resource());
+
+        std::pmr::monotonic_buffer_resource other_arena;
+        Vector<std::pmr::string, std::pmr::polymorphic_allocator<std::pmr::string>> v_other(&other_arena);
+        v_other = std::move(v);
+        assert(v_other.GetAllocator().resource() == &other_arena);
+        assert(v_other.Size() == SIZE);
+        assert(v_other[0].get_allocator().resource() == &other_arena);
+    }
+    {
+        using Alloc = TrackingAllocator<Obj, false>;
+        Obj::ResetCounters();
+        Alloc::ResetCounters();
+        {
+            Vector<Obj, Alloc> v(SIZE, Alloc{1});
+            Vector<Obj, Alloc> v_same(Alloc{1});
+            const int moves = Obj::num_moved;
+            v_same = std::move(v);
+            assert(v_same.Size() == SIZE);
+            assert(v.Size() == 0);
+            assert(Obj::num_moved == moves);
+
+            Vector<Obj, Alloc> v_other(Alloc{2});
+            v_other = std::move(v_same);
+            assert(v_other.Size() == SIZE);
+            assert(v_other.GetAllocator().id == 2);
+            assert(Obj::num_moved == moves + static_cast<int>(SIZE));
+        }
+        assert(Obj::GetAliveObjectCount() == 0);
+        assert(Alloc::num_allocations == Alloc::num_deallocations);
+    }
+    {
+        using Alloc = TrackingAllocator<Obj, true>;
+        Obj::ResetCounters();
+        Alloc::ResetCounters();
+        {
+            Vector<Obj, Alloc> v(SIZE, Alloc{1});
+            Vector<Obj, Alloc> v_copy(SIZE * 2, Alloc{2});
+            v_copy = v;
+            assert(v_copy.GetAllocator().id == 1);
+            assert(v_copy.Capacity() == SIZE);
+
+            Vector<Obj, Alloc> v_moved(Alloc{3});
+            v_moved = std::move(v_copy);
+            assert(v_moved.GetAllocator().id == 1);
+            assert(Obj::num_moved == 0);
+
+            v_moved.Swap(v_copy);
+            assert(v_copy.GetAllocator().id == 1);
+            assert(v_copy.Size() == SIZE);
+        }
+        assert(Obj::GetAliveObjectCount() == 0);
+        assert(Alloc::num_allocations == Alloc::num_deallocations);
+    }
+}
+
+void Test7() {
+    const int SIZE = 1024;
+    {
+        RelocatableObj::ResetCounters();
+        {
+            Vector<RelocatableObj> v;
+            for (int i = 0; i < SIZE; ++i) {
+                v.EmplaceBack(i);
+            }
+            assert(v.Size() == v.Capacity());
+            v.Emplace(v.begin() + SIZE / 2, -1);
+            v.Reserve(SIZE * 4);
+            assert(RelocatableObj::num_moved == 0);
+            assert(RelocatableObj::num_destroyed == 0);
+            assert(v[SIZE / 2].id == -1);
+            assert(v[SIZE / 2 + 1].id == SIZE / 2);
+            assert(v[SIZE].id == SIZE - 1);
+        }
+        assert(RelocatableObj::num_destroyed == SIZE + 1);
+    }
+    {
+        Vector<std::unique_ptr<int>> v;
+        for (int i = 0; i < SIZE; ++i) {
+            v.PushBack(std::make_unique<int>(i));
+        }
+        v.Emplace(v.begin(), std::make_unique<int>(-1));
+        assert(*v[0] == -1);
+        assert(*v[SIZE] == SIZE - 1);
+    }
+    {
+        Vector<int> v;
+        for (int i = 0; i < SIZE; ++i) {
+            v.Insert(v.begin(), i);
+        }
+        assert(v[0] == SIZE - 1);
+        assert(v[SIZE - 1] == 0);
+    }
+}
+
+void Test8() {
+    const int SIZE = 1024;
+    {
+        Vector<int, MallocAllocator<int>> v;
+        for (int i = 0; i < SIZE; ++i) {
+            v.PushBack(i);
+        }
+        assert(v.Size() == v.Capacity());
+        v.Emplace(v.begin(), v[SIZE - 1]);
+        assert(v[0] == SIZE - 1);
+        assert(v[1] == 0);
+        assert(v[SIZE] == SIZE - 1);
+
+        v.Reserve(SIZE * SIZE);
+        assert(v.Capacity() == SIZE * SIZE);
+        assert(v[SIZE / 2] == SIZE / 2 - 1);
+
+        Vector<int, MallocAllocator<int>> v_copy(v);
+        v = std::move(v_copy);
+        assert(v.Size() == SIZE + 1);
+    }
+    {
+        RelocatableObj::ResetCounters();
+        {
+            Vector<RelocatableObj, MallocAllocator<RelocatableObj>> v;
+            for (int i = 0; i < SIZE; ++i) {
+                v.EmplaceBack(i);
+            }
+            v.Emplace(v.begin() + 1, -1);
+            assert(RelocatableObj::num_moved == 0);
+            assert(RelocatableObj::num_destroyed == 0);
+            assert(v[1].id == -1);
+            assert(v[2].id == 1);
+        }
+        assert(RelocatableObj::num_destroyed == SIZE + 1);
+    }
+}
+
+void Test9() {
+    {
+        Vector<int, std::allocator<int>, GeometricGrowth<>> v;
+        v.PushBack(1);
+        assert(v.Capacity() == 4);
+        for (int i = 0; i < 4; ++i) {
+            v.PushBack(i);
+        }
+        assert(v.Capacity() == 6);
+        v.Resize(7);
+        assert(v.Capacity() == 9);
+        v.Resize(100);
+        assert(v.Capacity() == 100);
+    }
+    {
+        Vector<int, std::allocator<int>, DoublingGrowth<8>> v;
+        v.EmplaceBack(1);
+        assert(v.Capacity() == 8);
+        v.Resize(9);
+        assert(v.Capacity() == 16);
+    }
+    {
+        Vector<char, std::allocator<char>, PageRoundedGrowth<>> v;
+        v.PushBack('a');
+        assert(v.Capacity() == 4096);
+    }
+    {
+        static_assert(SizeClassGrowth<>::RoundToSizeClass(1) == 8);
+        static_assert(SizeClassGrowth<>::RoundToSizeClass(17) == 32);
+        static_assert(SizeClassGrowth<>::RoundToSizeClass(65) == 80);
+        static_assert(SizeClassGrowth<>::RoundToSizeClass(257) == 320);
+        static_assert(SizeClassGrowth<>::RoundToSizeClass(4097) == 5120);
+
+        Vector<Obj, std::allocator<Obj>, SizeClassGrowth<>> v;
+        v.EmplaceBack();
+        v.EmplaceBack();
+        assert(v.Capacity() * sizeof(Obj) <= SizeClassGrowth<>::RoundToSizeClass(2 * sizeof(Obj)));
+        assert(v.Capacity() >= 2);
+    }
+}
+
+void Test10() {
+    const size_t SIZE = 8;
+    using Alloc = TrackingAllocator<Obj, false>;
+    using Small = SmallVector<Obj, SIZE, Alloc>;
+    {
+        Obj::ResetCounters();
+        Alloc::ResetCounters();
+        {
+            Small v(Alloc{1});
+            assert(v.Capacity() == SIZE);
+            for (size_t i = 0; i < SIZE; ++i) {
+                v.EmplaceBack(static_cast<int>(i));
+            }
+            v.Erase(v.begin());
+            v.Emplace(v.begin() + 2, 42);
+            v.Resize(SIZE);
+            assert(Alloc::num_allocations == 0);
+            assert(v[2].id == 42);
+
+            const int moves_before = Obj::num_moved;
+            Small v_moved(std::move(v));
+            assert(v.Size() == 0);
+            assert(v_moved.Size() == SIZE);
+            assert(v_moved[2].id == 42);
+            assert(Obj::num_moved - moves_before == static_cast<int>(SIZE));
+
+            v_moved.PushBack(Obj{7});
+            assert(Alloc::num_allocations == 1);
+            assert(v_moved.Capacity() == SIZE * 2);
+            assert(v_moved[SIZE].id == 7);
+
+            Small v_small(2, Alloc{1});
+            v_small.Swap(v_moved);
+            assert(v_small.Size() == SIZE + 1);
+            assert(v_moved.Size() == 2);
+            assert(v_moved.Capacity() == SIZE);
+            assert(v_small[2].id == 42);
+
+            const int moves = Obj::num_moved;
+            Small v_heap(Alloc{1});
+            v_heap = std::move(v_small);
+            assert(Obj::num_moved == moves);
+            assert(v_heap.Size() == SIZE + 1);
+
+            Small v_copy(v_heap);
+            assert(v_copy.Size() == SIZE + 1);
+            int sum = 0;
+            for (const Obj& obj : v_copy) {
+                sum += obj.id;
+            }
+            assert(sum == 1 + 42 + 2 + 3 + 4 + 5 + 6 + 7 + 7);
+        }
+        assert(Obj::GetAliveObjectCount() == 0);
+        assert(Alloc::num_allocations == Alloc::num_deallocations);
+    }
+    Obj::ResetCounters();
+    {
+        Obj::default_construction_throw_countdown = SIZE / 2;
+        try {
+            SmallVector<Obj, SIZE> v(SIZE);
+            assert(false && "Exception is expected");
+        } catch (const std::runtime_error&) {
+        }
+        assert(Obj::GetAliveObjectCount() == 0);
+    }
+    Obj::ResetCounters();
+    {
+        SmallVector<Obj, SIZE> v(SIZE);
+        try {
+            v[SIZE / 2].throw_on_copy = true;
+            SmallVector<Obj, SIZE> v_copy(v);
+            assert(false && "Exception is expected");
+        } catch (const std::runtime_error&) {
+            assert(Obj::num_copied == SIZE / 2);
+        }
+        assert(Obj::GetAliveObjectCount() == SIZE);
+
+        v[SIZE - 1].throw_on_copy = true;
+        v.Reserve(SIZE * 2);
+        assert(v.Capacity() == SIZE * 2);
+        assert(v.Size() == SIZE);
+        assert(Obj::GetAliveObjectCount() == SIZE);
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+    {
+        SmallVector<int, 4, MallocAllocator<int>> v;
+        for (int i = 0; i < 100; ++i) {
+            v.Insert(v.begin(), i);
+        }
+        assert(v[0] == 99);
+        assert(v[99] == 0);
+    }
+}
+
+void Test11() {
+    using namespace std::literals;
+    {
+        const std::list<int> source{1, 2, 3, 4, 5};
+        Vector<int> v(source.begin(), source.end());
+        assert(v.Size() == 5);
+        assert(v.Capacity() == 5);
+
+        v.Insert(v.begin() + 1, source.begin(), source.end());
+        assert(v.Size() == 10);
+        assert(v[0] == 1 && v[1] == 1 && v[5] == 5 && v[6] == 2 && v[9] == 5);
+
+        v.Insert(v.begin(), 3, v[9]);
+        assert(v.Size() == 13);
+        assert(v[0] == 5 && v[2] == 5 && v[3] == 1);
+
+        std::istringstream input("7 8 9");
+        v.Append(std::istream_iterator<int>(input), std::istream_iterator<int>());
+        assert(v.Size() == 16);
+        assert(v[13] == 7 && v[15] == 9);
+
+        std::istringstream more_input("10 11");
+        v.Insert(v.begin(), std::istream_iterator<int>(more_input), std::istream_iterator<int>());
+        assert(v[0] == 10 && v[1] == 11 && v[2] == 5);
+    }
+    {
+        using Alloc = TrackingAllocator<Obj, false>;
+        const size_t SIZE = 100;
+        const int ID = 42;
+        Obj::ResetCounters();
+        Alloc::ResetCounters();
+        {
+            Vector<Obj, Alloc> v(SIZE, Alloc{1});
+            Vector<Obj> batch(SIZE);
+            v.Insert(v.begin() + SIZE / 2, batch.begin(), batch.end());
+            assert(Alloc::num_allocations == 2);
+            assert(v.Size() == SIZE * 2);
+            assert(Obj::num_copied == static_cast<int>(SIZE));
+            assert(Obj::num_moved == static_cast<int>(SIZE));
+
+            v.Reserve(SIZE * 4);
+            Obj::ResetCounters();
+            v.Insert(v.begin() + SIZE, SIZE / 2, Obj{ID});
+            assert(Obj::num_copied == 1);
+            assert(Obj::num_moved == static_cast<int>(SIZE / 2));
+            assert(v[SIZE].id == ID && v[SIZE + SIZE / 2 - 1].id == ID);
+
+            Obj::ResetCounters();
+            v.Append(batch.begin(), batch.end());
+            v.Insert(v.begin() + 1, batch.begin(), batch.begin() + SIZE / 4);
+            assert(Alloc::num_allocations == 3);
+            assert(Obj::num_moved == static_cast<int>(SIZE / 4));
+        }
+        assert(Alloc::num_allocations == Alloc::num_deallocations);
+    }
+    Obj::ResetCounters();
+    {
+        Vector<Obj> v(10);
+        Vector<Obj> batch(10);
+        batch[5].throw_on_copy = true;
+        try {
+            v.Insert(v.begin() + 5, batch.begin(), batch.end());
+            assert(false && "Exception is expected");
+        } catch (const std::runtime_error&) {
+        }
+        assert(v.Size() == 10);
+        assert(v.Capacity() == 10);
+        assert(Obj::GetAliveObjectCount() == 20);
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+    {
+        Vector<std::string> v;
+        v.Insert(v.begin(), 4, "x"s);
+        const std::string strings[] = {"a"s, "b"s, "c"s};
+        v.Reserve(16);
+        v.Insert(v.begin() + 3, std::begin(strings), std::end(strings));
+        assert(v[2] == "x"s && v[3] == "a"s && v[5] == "c"s && v[6] == "x"s);
+        v.Insert(v.begin(), std::begin(strings), std::end(strings));
+        assert(v[0] == "a"s && v[3] == "x"s && v.Size() == 10);
+    }
+}
+
+void Test12() {
+    const int SIZE = 100;
+    {
+        Obj::ResetCounters();
+        Vector<Obj> v;
+        v.Reserve(SIZE);
+        for (int i = 0; i < SIZE; ++i) {
+            v.EmplaceBack(i);
+        }
+        auto it = v.Erase(v.begin() + 10, v.begin() + 20);
+        assert(it->id == 20);
+        assert(v.Size() == SIZE - 10);
+        assert(Obj::num_destroyed == 10);
+        assert(v.Erase(v.end(), v.end()) == v.end());
+
+        const size_t erased = EraseIf(v, [](const Obj& obj) {
+            return obj.id % 2 == 0;
+        });
+        assert(erased == (SIZE - 10) / 2);
+        assert(v.Size() == (SIZE - 10) / 2);
+        assert(v[0].id == 1 && v[4].id == 9 && v[5].id == 21);
+        assert(Obj::GetAliveObjectCount() == static_cast<int>(v.Size()));
+
+        v.Clear();
+        assert(v.Size() == 0);
+        assert(v.Capacity() == SIZE);
+        assert(Obj::GetAliveObjectCount() == 0);
+    }
+    {
+        RelocatableObj::ResetCounters();
+        Vector<RelocatableObj> v;
+        for (int i = 0; i < SIZE; ++i) {
+            v.EmplaceBack(i);
+        }
+        v.Erase(v.begin(), v.begin() + SIZE / 2);
+        v.Erase(v.begin() + 1);
+        assert(v.Size() == SIZE / 2 - 1);
+        assert(v[0].id == SIZE / 2 && v[1].id == SIZE / 2 + 2);
+        assert(RelocatableObj::num_moved == 0);
+        assert(RelocatableObj::num_destroyed == SIZE / 2 + 1);
+    }
+    {
+        Vector<std::unique_ptr<int>> v;
+        for (int i = 0; i < SIZE; ++i) {
+            v.PushBack(std::make_unique<int>(i));
+        }
+        EraseIf(v, [](const std::unique_ptr<int>& p) {
+            return *p < SIZE - 1;
+        });
+        assert(v.Size() == 1 && *v[0] == SIZE - 1);
+    }
+}
+
+void Test13() {
+    const size_t SIZE = 100;
+    {
+        Obj::ResetCounters();
+        Vector<Obj> v(SIZE, DefaultInit);
+        assert(v.Size() == SIZE);
+        assert(Obj::num_default_constructed == SIZE);
+        v.ResizeDefaultInit(SIZE * 2);
+        assert(v.Size() == SIZE * 2);
+        assert(Obj::num_default_constructed == SIZE * 2);
+        v.ResizeDefaultInit(SIZE);
+        assert(Obj::GetAliveObjectCount() == SIZE);
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+    {
+        Vector<char> v(SIZE, DefaultInit);
+        v[0] = 'a';
+        v.ResizeAndOverwrite(SIZE * 10, [](char* data, size_t count) {
+            assert(count == SIZE * 10);
+            assert(data[0] == 'a');
+            std::memcpy(data + 1, "bcd", 3);
+            return size_t{4};
+        });
+        assert(v.Size() == 4);
+        assert(v.Capacity() >= SIZE * 10);
+        assert(std::string(v.begin(), v.end()) == "abcd");
+    }
+    {
+        Obj::ResetCounters();
+        Vector<Obj> v(SIZE);
+        try {
+            v.ResizeAndOverwrite(SIZE * 2, [](Obj*, size_t) -> size_t {
+                throw std::runtime_error("Oops");
+            });
+            assert(false && "Exception is expected");
+        } catch (const std::runtime_error&) {
+        }
+        assert(v.Size() == SIZE);
+        assert(Obj::GetAliveObjectCount() == SIZE);
+        v.ResizeAndOverwrite(SIZE / 2, [](Obj* data, size_t count) {
+            data[0].id = 42;
+            return count / 2;
+        });
+        assert(v.Size() == SIZE / 4 && v[0].id == 42);
+        assert(Obj::GetAliveObjectCount() == SIZE / 4);
+    }
+}
+
+void Test14() {
+    const size_t SIZE = 100;
+    {
+        Obj::ResetCounters();
+        Vector<Obj> v(SIZE);
+        v.Resize(SIZE / 2);
+        v.ShrinkTo(SIZE / 4);
+        assert(v.Capacity() == SIZE / 2);
+        v.ShrinkTo(SIZE);
+        assert(v.Capacity() == SIZE / 2);
+        v.Reserve(SIZE * 2);
+        v.ShrinkToFit();
+        assert(v.Capacity() == SIZE / 2);
+        assert(Obj::GetAliveObjectCount() == SIZE / 2);
+        v.Clear();
+        v.ShrinkToFit();
+        assert(v.Capacity() == 0);
+        assert(v.begin() == nullptr);
+    }
+    {
+        Vector<int, MallocAllocator<int>> v(SIZE);
+        v[SIZE / 4 - 1] = 42;
+        v.Resize(SIZE / 4);
+        v.ShrinkToFit();
+        assert(v.Capacity() == SIZE / 4);
+        assert(v[SIZE / 4 - 1] == 42);
+        v.Clear();
+        v.ShrinkToFit();
+        assert(v.Capacity() == 0);
+    }
+    {
+        SmallVector<std::string, 4> v;
+        v.Resize(SIZE);
+        v[1] = "inline";
+        v.Resize(2);
+        v.ShrinkToFit();
+        assert(v.Capacity() == 4);
+        assert(v[1] == "inline");
+    }
+    {
+        Vector<int, std::allocator<int>, ShrinkingGrowth<>> v;
+        for (int i = 0; i < 64; ++i) {
+            v.PushBack(i);
+        }
+        assert(v.Capacity() == 64);
+        v.Erase(v.begin(), v.begin() + 48);
+        assert(v.Capacity() == 64);
+        v.PopBack();
+        assert(v.Capacity() == 32);
+        assert(v.Size() == 15 && v[0] == 48 && v[14] == 62);
+        v.PushBack(63);
+        v.PopBack();
+        assert(v.Capacity() == 32);
+        v.Resize(1);
+        assert(v.Capacity() == 4);
+        v.Clear();
+        assert(v.Capacity() == 4);
+    }
+    {
+        using Small = SmallVector<int, 8, MallocAllocator<int>>;
+        const auto is_inline = [](const Small& v) {
+            const void* data = v.begin();
+            return data >= static_cast<const void*>(&v) && data < static_cast<const void*>(&v + 1);
+        };
+        Small v;
+        v.PushBack(1);
+        v.PushBack(2);
+        v.ShrinkToFit();
+        assert(is_inline(v) && v.Capacity() == 8);
+        assert(v.Size() == 2 && v[0] == 1 && v[1] == 2);
+
+        v.Resize(SIZE);
+        assert(!is_inline(v));
+        v[SIZE - 1] = 42;
+        v.ShrinkTo(SIZE / 2 + 1);
+        assert(!is_inline(v) && v.Capacity() == SIZE);
+        v.Resize(SIZE / 2);
+        v.ShrinkToFit();
+        assert(!is_inline(v) && v.Capacity() == SIZE / 2);
+        v.Resize(3);
+        v.ShrinkToFit();
+        assert(is_inline(v) && v.Capacity() == 8);
+        assert(v.Size() == 3 && v[0] == 1 && v[1] == 2 && v[2] == 0);
+    }
+    {
+        SmallVector<int, 8, MallocAllocator<int>, ShrinkingGrowth<>> v;
+        for (int i = 0; i < 64; ++i) {
+            v.PushBack(i);
+        }
+        assert(v.Capacity() == 64);
+        v.Erase(v.begin(), v.begin() + 40);
+        assert(v.Capacity() == 64);
+        v.Resize(10);
+        assert(v.Capacity() == 32);
+        v.PopBack();
+        v.PopBack();
+        v.PopBack();
+        assert(v.Capacity() == 16);
+        v.Erase(v.begin() + 1, v.end());
+        assert(v.Capacity() == 8 && v.Size() == 1 && v[0] == 40);
+        const void* data = v.begin();
+        assert(data >= static_cast<const void*>(&v) && data < static_cast<const void*>(&v + 1));
+    }
+}
+
+void Test15() {
+    const size_t ALIGNMENT = 64;
+    const auto is_aligned = [](const void* p) {
+        return reinterpret_cast<uintptr_t>(p) % ALIGNMENT == 0;
+    };
+    {
+        Vector<float, AlignedAllocator<float, ALIGNMENT>> v;
+        v.Reserve(10);
+        assert(v.Capacity() == 16);
+        assert(is_aligned(v.begin()));
+        for (int i = 0; i < 100; ++i) {
+            v.PushBack(static_cast<float>(i));
+            assert(is_aligned(v.begin()));
+            assert(v.Capacity() % 16 == 0);
+        }
+        assert(v[99] == 99.0f);
+        v.ShrinkToFit();
+        assert(v.Capacity() == 112);
+
+        const Vector<float, AlignedAllocator<float, ALIGNMENT>> v_copy(v);
+        assert(is_aligned(v_copy.begin()));
+        assert(v_copy.Capacity() == 112);
+    }
+    {
+        Obj::ResetCounters();
+        Vector<Obj, AlignedAllocator<Obj, ALIGNMENT>> v(3);
+        v.EmplaceBack(7);
+        assert(is_aligned(v.begin()));
+        assert(v[3].id == 7);
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+}
+
+void Test16() {
+    struct Counted {
+        int value = 0;
+    };
+    struct Reallocated {
+        int value = 0;
+    };
+    struct Adopted {
+        int value = 0;
+    };
+    {
+        Vector<Counted> v;
+        for (int i = 0; i < 5; ++i) {
+            v.PushBack(Counted{i});
+        }
+        const VectorStats& stats = VectorStatsFor<Counted>();
+        assert(stats.allocations == 4);
+        assert(stats.deallocations == 3);
+        assert(stats.reallocations == 3);
+        assert(stats.relocated_bytes == (1 + 2 + 4) * sizeof(Counted));
+        assert(stats.peak_capacity == 8);
+
+        v.ShrinkToFit();
+        assert(stats.reallocations == 4);
+        assert(stats.relocated_bytes == (1 + 2 + 4 + 5) * sizeof(Counted));
+    }
+    {
+        const VectorStats& stats = VectorStatsFor<Counted>();
+        assert(stats.allocations == stats.deallocations);
+        assert(stats.retired_vectors == 1);
+        assert(stats.wasted_capacity == 0);
+
+        Vector<Counted>(10).PopBack();
+        assert(stats.retired_vectors == 2);
+        assert(stats.wasted_capacity == 1);
+    }
+    {
+        Vector<Reallocated, MallocAllocator<Reallocated>> v;
+        v.Reserve(4);
+        v.Resize(4);
+        v.Reserve(16);
+        const VectorStats& stats = VectorStatsFor<Reallocated>();
+        assert(stats.allocations == 1);
+        assert(stats.reallocations == 1);
+        assert(stats.relocated_bytes == 4 * sizeof(Reallocated));
+        assert(stats.peak_capacity == 16);
+    }
+    {
+        int num_freed = 0;
+        Adopted* buffer = static_cast<Adopted*>(std::malloc(8 * sizeof(Adopted)));
+        buffer[0].value = 1;
+        buffer[1].value = 2;
+        {
+            Vector<Adopted, MallocAllocator<Adopted>> v;
+            v.Adopt(buffer, 2, 8, [&num_freed](Adopted* p) {
+                ++num_freed;
+                std::free(p);
+            });
+            v.Reserve(16);
+            assert(num_freed == 1 && v[0].value == 1 && v[1].value == 2);
+            const VectorStats& stats = VectorStatsFor<Adopted>();
+            assert(stats.allocations == 1);
+            assert(stats.reallocations == 1);
+            assert(stats.relocated_bytes == 2 * sizeof(Adopted));
+            assert(stats.peak_capacity == 16);
+        }
+        assert(VectorStatsFor<Adopted>().deallocations == 1);
+    }
+    {
+        bool found = false;
+        VectorStatsRegistry::Instance().ForEach([&found](const char* type_name, const VectorStats& stats) {
+            if (std::strcmp(type_name, typeid(Counted).name()) == 0) {
+                found = stats.retired_vectors == 2;
+            }
+        });
+        assert(found);
+
+        VectorStatsRegistry::Instance().ResetAll();
+        assert(VectorStatsFor<Counted>().allocations == 0);
+        assert(VectorStatsFor<Reallocated>().peak_capacity == 0);
+    }
+}
+
+void Test17() {
+    const ParallelTag policy{4};
+    const size_t SIZE = size_t(1) << 19;
+    {
+        Vector<int> v(policy, SIZE);
+        assert(v.Size() == SIZE);
+        assert(std::all_of(v.begin(), v.end(), [](int value) { return value == 0; }));
+        for (size_t i = 0; i < SIZE; ++i) {
+            v[i] = static_cast<int>(i);
+        }
+
+        const Vector<int> v_copy(policy, v);
+        assert(std::equal(v.begin(), v.end(), v_copy.begin(), v_copy.end()));
+
+        Vector<int> v_assigned(3);
+        v_assigned.Assign(policy, v_copy);
+        assert(std::equal(v.begin(), v.end(), v_assigned.begin(), v_assigned.end()));
+
+        v_assigned.Resize(10);
+        v_assigned.Assign(policy, v_copy);
+        assert(std::equal(v.begin(), v.end(), v_assigned.begin(), v_assigned.end()));
+    }
+    {
+        Vector<std::string> v;
+        v.Reserve(SIZE / 8);
+        for (size_t i = 0; i < SIZE / 8; ++i) {
+            v.EmplaceBack(std::to_string(i));
+        }
+        v.Reserve(policy, SIZE);
+        assert(v.Capacity() == SIZE);
+        for (size_t i = 0; i < SIZE / 8; ++i) {
+            assert(v[i] == std::to_string(i));
+        }
+    }
+    {
+        Vector<ParallelObj> v(policy, SIZE);
+        assert(ParallelObj::num_alive == static_cast<int>(SIZE));
+        v[SIZE - 1].throw_on_copy = true;
+        try {
+            Vector<ParallelObj> v_copy(policy, v);
+            assert(false);
+        }
+        catch (const std::runtime_error&) {
+        }
+        assert(ParallelObj::num_alive == static_cast<int>(SIZE));
+
+        Vector<ParallelObj> v_assigned;
+        try {
+            v_assigned.Assign(policy, v);
+            assert(false);
+        }
+        catch (const std::runtime_error&) {
+        }
+        assert(v_assigned.Size() == 0);
+        assert(ParallelObj::num_alive == static_cast<int>(SIZE));
+    }
+    assert(ParallelObj::num_alive == 0);
+}
+
+void Test18() {
+    using Allocator = HugePageAllocator<int>;
+    const size_t HUGE_PAGE_SIZE = Allocator::kHugePageSize;
+    const auto is_huge_page_aligned = [HUGE_PAGE_SIZE](const void* p) {
+        return reinterpret_cast<uintptr_t>(p) % HUGE_PAGE_SIZE == 0;
+    };
+    {
+        Vector<int, Allocator> v;
+        for (int i = 0; i < (1 << 20); ++i) {
+            v.PushBack(i);
+        }
+        for (int i = 0; i < (1 << 20); ++i) {
+            assert(v[i] == i);
+        }
+        v.ShrinkTo(10);
+        assert(v.Capacity() == 1 << 20);
+        v.Resize(10);
+        v.ShrinkToFit();
+        assert(v.Capacity() == 10);
+        assert(v[9] == 9);
+    }
+    {
+        Vector<int, Allocator> v(Allocator(NumaPolicy::Bind(0)));
+        v.Reserve(HUGE_PAGE_SIZE);
+        assert(is_huge_page_aligned(v.begin()));
+        v.Resize(HUGE_PAGE_SIZE);
+        assert(v[HUGE_PAGE_SIZE - 1] == 0);
+
+        const Vector<int, Allocator> v_copy(v);
+        assert(is_huge_page_aligned(v_copy.begin()));
+        assert(v_copy.GetAllocator().GetNumaPolicy() == NumaPolicy::Bind(0));
+    }
+    {
+        // The hugetlbfs pool is usually empty, the allocator falls back to transparent huge pages
+        Vector<int, Allocator> v(HUGE_PAGE_SIZE, Allocator(NumaPolicy::Interleave(1), true));
+        assert(is_huge_page_aligned(v.begin()));
+        v[0] = 1;
+        v.Reserve(HUGE_PAGE_SIZE * 2);
+        assert(v[0] == 1);
+    }
+}
+
+void Test19() {
+    struct Record {
+        int64_t key;
+        double value;
+    };
+    const std::string path = (std::filesystem::temp_directory_path() / "advanced_vector_test19.bin").string();
+    {
+        MappedVector<Record> v(path, MapMode::TRUNCATE);
+        assert(v.Size() == 0);
+        for (int i = 0; i < 10000; ++i) {
+            v.PushBack({i, i * 0.5});
+        }
+        v.EmplaceBack(Record{-1, -1.0});
+        v.PopBack();
+        v.Sync();
+    }
+    {
+        MappedVector<Record> v(path);
+        assert(v.Size() == 10000);
+        assert(v[9999].key == 9999 && v[9999].value == 9999 * 0.5);
+        v.Resize(10002);
+        assert(v[10001].key == 0);
+        v.ShrinkToFit();
+        assert(v.Capacity() == 10002);
+        assert(std::filesystem::file_size(path) == 64 + 10002 * sizeof(Record));
+    }
+    {
+        const MappedVector<Record> v(path, MapMode::READ_ONLY);
+        assert(v.IsReadOnly());
+        assert(v.Size() == 10002);
+        int64_t sum = 0;
+        for (const Record& record : v) {
+            sum += record.key;
+        }
+        assert(sum == 9999 * 10000 / 2);
+    }
+    {
+        try {
+            MappedVector<int> v(path);
+            assert(false);
+        }
+        catch (const std::runtime_error&) {
+        }
+        try {
+            MappedVector<Record> v(path + ".missing", MapMode::READ_ONLY);
+            assert(false);
+        }
+        catch (const std::system_error&) {
+        }
+    }
+    {
+        MappedVector<Record> v(path, MapMode::TRUNCATE);
+        assert(v.Size() == 0 && v.Capacity() == 0);
+    }
+    std::filesystem::remove(path);
+}
+
+void Test20() {
+    struct Point {
+        double x;
+        double y;
+    };
+    Vector<Point> points;
+    for (int i = 0; i < 1000; ++i) {
+        points.PushBack(Point{i * 1.0, i * 2.0});
+    }
+    const auto same_points = [&points](const auto& other) {
+        return std::equal(points.begin(), points.end(), other.begin(), other.end(), [](const Point& lhs, const Point& rhs) {
+            return lhs.x == rhs.x && lhs.y == rhs.y;
+        });
+    };
+    {
+        std::stringstream stream;
+        Serialize(points, stream);
+        assert(stream.str().size() == SerializedSize(points));
+
+        Vector<Point> loaded(3);
+        Deserialize(stream, loaded);
+        assert(same_points(loaded));
+
+        alignas(32) std::byte buffer[32 + 1000 * sizeof(Point)];
+        std::memcpy(buffer, stream.str().data(), sizeof(buffer));
+        const std::span<const Point> view = DeserializeView<Point>(buffer);
+        assert(view.data() == reinterpret_cast<const Point*>(buffer + 32));
+        assert(same_points(view));
+
+        try {
+            DeserializeView<Point>(std::span<const std::byte>(buffer, 100));
+            assert(false);
+        }
+        catch (const std::runtime_error&) {
+        }
+        try {
+            Vector<int> ints;
+            stream.seekg(0);
+            Deserialize(stream, ints);
+            assert(false);
+        }
+        catch (const std::runtime_error&) {
+        }
+
+        for (const uint64_t count : {uint64_t(1001), ~uint64_t(0) / sizeof(Point) + 1, ~uint64_t(0)}) {
+            SerializedHeader header;
+            std::memcpy(&header, buffer, sizeof(header));
+            header.count = count;
+            std::string corrupt = stream.str();
+            std::memcpy(corrupt.data(), &header, sizeof(header));
+            std::istringstream corrupt_stream(corrupt);
+            Vector<Point> corrupt_points;
+            try {
+                Deserialize(corrupt_stream, corrupt_points);
+                assert(false);
+            }
+            catch (const std::runtime_error&) {
+            }
+            assert(corrupt_points.Capacity() == 0);
+        }
+    }
+    {
+        const std::string path = (std::filesystem::temp_directory_path() / "advanced_vector_test20.bin").string();
+        const int out = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        assert(out >= 0);
+        Serialize(points, out);
+        Serialize(Vector<Point>(), out);
+        ::close(out);
+        assert(std::filesystem::file_size(path) == SerializedSize(points) + 32);
+
+        const int in = ::open(path.c_str(), O_RDONLY);
+        assert(in >= 0);
+        Vector<Point> loaded;
+        Deserialize(in, loaded);
+        assert(same_points(loaded));
+        Deserialize(in, loaded);
+        assert(loaded.Size() == 0);
+        try {
+            Deserialize(in, loaded);
+            assert(false);
+        }
+        catch (const std::runtime_error&) {
+        }
+        ::close(in);
+
+        SerializedHeader header = detail::MakeSerializedHeader<Point>(~uint64_t(0) / 2);
+        const int corrupt_out = ::open(path.c_str(), O_WRONLY | O_TRUNC);
+        assert(corrupt_out >= 0);
+        const ssize_t written = ::write(corrupt_out, &header, sizeof(header));
+        assert(written == sizeof(header));
+        ::close(corrupt_out);
+        const int corrupt_in = ::open(path.c_str(), O_RDONLY);
+        assert(corrupt_in >= 0);
+        Vector<Point> corrupt_points;
+        try {
+            Deserialize(corrupt_in, corrupt_points);
+            assert(false);
+        }
+        catch (const std::runtime_error&) {
+        }
+        assert(corrupt_points.Capacity() == 0);
+        ::close(corrupt_in);
+        std::filesystem::remove(path);
+    }
+}
+
+void Test21() {
+    {
+        int num_freed = 0;
+        const auto free_buffer = [&num_freed](int* p) {
+            ++num_freed;
+            std::free(p);
+        };
+
+        int* buffer = static_cast<int*>(std::malloc(4 * sizeof(int)));
+        buffer[0] = 1;
+        buffer[1] = 2;
+        Vector<int> v(5);
+        v.Adopt(buffer, 2, 4, free_buffer);
+        assert(v.IsAdopted());
+        assert(v.begin() == buffer && v.Size() == 2 && v.Capacity() == 4);
+        v.PushBack(3);
+        v.PushBack(4);
+        assert(v.begin() == buffer && num_freed == 0);
+
+        v.PushBack(5);
+        assert(!v.IsAdopted());
+        assert(num_freed == 1);
+        assert(v[0] == 1 && v[4] == 5);
+
+        ReleasedBuffer<int> released = v.Release();
+        assert(v.Size() == 0 && v.Capacity() == 0 && v.begin() == nullptr);
+        assert(released.size == 5 && released.data[4] == 5);
+
+        Vector<int> other;
+        other.Adopt(released.data, released.size, released.capacity);
+        assert(other.Size() == 5 && other[0] == 1);
+        assert(!other.IsAdopted());
+
+        Vector<int, MallocAllocator<int>> in_place;
+        buffer = static_cast<int*>(std::malloc(2 * sizeof(int)));
+        buffer[0] = 7;
+        in_place.Adopt(buffer, 1, 2, free_buffer);
+        in_place.Reserve(100);
+        assert(num_freed == 2);
+        assert(in_place[0] == 7);
+    }
+    {
+        std::allocator<std::string> alloc;
+        std::string* buffer = alloc.allocate(3);
+        std::construct_at(buffer, "a string that does not fit into SSO");
+        int num_freed = 0;
+
+        SmallVector<std::string, 2> v;
+        v.EmplaceBack("inline");
+        v.Adopt(buffer, 1, 3, [&num_freed, alloc](std::string* p) mutable {
+            ++num_freed;
+            alloc.deallocate(p, 3);
+        });
+        assert(v.IsAdopted());
+        assert(v[0] == "a string that does not fit into SSO");
+        v.EmplaceBack("b");
+        v.ShrinkTo(0);
+        assert(num_freed == 1);
+        assert(v[1] == "b");
+    }
+}
+
+void Test22() {
+    const int NUM_THREADS = 4;
+    const int PER_THREAD = 20000;
+    {
+        ConcurrentVector<int> v;
+        const int& first = v.EmplaceBack(-1);
+
+        std::vector<std::thread> threads;
+        for (int t = 0; t < NUM_THREADS; ++t) {
+            threads.emplace_back([&v, t] {
+                for (int i = 0; i < PER_THREAD; ++i) {
+                    v.PushBack(t * PER_THREAD + i);
+                }
+            });
+        }
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+
+        assert(v.Size() == NUM_THREADS * PER_THREAD + 1);
+        assert(&first == &v[0] && first == -1);
+
+        Vector<int> frozen = v.Freeze();
+        assert(v.Size() == 0);
+        assert(frozen.Size() == NUM_THREADS * PER_THREAD + 1);
+        assert(frozen[0] == -1);
+        std::sort(frozen.begin(), frozen.end());
+        for (int i = 0; i < NUM_THREADS * PER_THREAD; ++i) {
+            assert(frozen[i + 1] == i);
+        }
+
+        v.PushBack(1);
+        assert(v.Size() == 1 && v[0] == 1);
+    }
+    {
+        ConcurrentVector<std::string, std::allocator<std::string>, 4> v;
+        v.Reserve(100);
+        for (int i = 0; i < 100; ++i) {
+            v.EmplaceBack(std::to_string(i));
+        }
+        const std::string* element = &v[50];
+        for (int i = 100; i < 1000; ++i) {
+            v.EmplaceBack(std::to_string(i));
+        }
+        assert(element == &v[50] && *element == "50");
+        assert(v[999] == "999");
+
+        const Vector<std::string> frozen = v.Freeze();
+        assert(frozen.Size() == 1000);
+        for (int i = 0; i < 1000; ++i) {
+            assert(frozen[i] == std::to_string(i));
+        }
+    }
+}
+
+void Test23() {
+    const int NUM_THREADS = 4;
+    const int PER_THREAD = 10000;
+    {
+        Vector<std::string> target;
+        std::mutex mutex;
+
+        std::vector<std::thread> threads;
+        for (int t = 0; t < NUM_THREADS; ++t) {
+            threads.emplace_back([&target, &mutex, t] {
+                BatchAppender appender(target, mutex, 256);
+                for (int i = 0; i < PER_THREAD; ++i) {
+                    appender.EmplaceBack(std::to_string(t * PER_THREAD + i));
+                    assert(appender.Pending() < 256);
+                }
+            });
+        }
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+
+        assert(target.Size() == NUM_THREADS * PER_THREAD);
+        std::vector<int> values;
+        for (const std::string& value : target) {
+            values.push_back(std::stoi(value));
+        }
+        std::sort(values.begin(), values.end());
+        for (int i = 0; i < NUM_THREADS * PER_THREAD; ++i) {
+            assert(values[i] == i);
+        }
+    }
+    {
+        Vector<int> target;
+        std::mutex mutex;
+        BatchAppender appender(target, mutex, 3);
+        appender.PushBack(1);
+        appender.PushBack(2);
+        assert(target.Size() == 0 && appender.Pending() == 2);
+        appender.PushBack(3);
+        assert(target.Size() == 3 && appender.Pending() == 0);
+        appender.PushBack(4);
+        appender.Flush();
+        assert(target.Size() == 4 && target[3] == 4);
+    }
+}
+
+void Test24() {
+    static_assert(std::random_access_iterator<SegmentedVector<int>::iterator>);
+    static_assert(std::random_access_iterator<SegmentedVector<int>::const_iterator>);
+    {
+        SegmentedVector<int, std::allocator<int>, 4> v;
+        v.PushBack(0);
+        const int* first = &v[0];
+        for (int i = 1; i < 1000; ++i) {
+            v.EmplaceBack(i);
+        }
+        assert(first == &v[0]);
+        assert(v.Size() == 1000 && v.Capacity() >= 1000);
+        for (int i = 0; i < 1000; ++i) {
+            assert(v[i] == i);
+        }
+        assert(std::accumulate(v.begin(), v.end(), 0) == 999 * 1000 / 2);
+
+        size_t count = 0;
+        v.ForEachSegment([&count, &v](const int* segment, size_t size) {
+            assert(segment == &v[count]);
+            count += size;
+        });
+        assert(count == 1000);
+
+        v.Emplace(v.begin() + 1, -1);
+        assert(v.Size() == 1001 && v[0] == 0 && v[1] == -1 && v[2] == 1 && v[1000] == 999);
+        v.Erase(v.begin());
+        assert(v[0] == -1 && v[999] == 999);
+        v.Insert(v.end(), 1000);
+        assert(v[1000] == 1000);
+
+        v.Resize(3);
+        v.ShrinkToFit();
+        assert(v.Size() == 3 && v.Capacity() == 4);
+        assert(first == &v[0]);
+    }
+    {
+        SegmentedVector<std::string> v(20);
+        v[19] = "a string that does not fit into SSO";
+        const SegmentedVector<std::string> v_copy(v);
+        assert(v_copy.Size() == 20 && v_copy[19] == v[19]);
+
+        SegmentedVector<std::string> v_moved(std::move(v));
+        assert(v_moved.Size() == 20 && v.Size() == 0);
+        v = v_copy;
+        assert(v.Size() == 20 && v[19] == v_copy[19]);
+        v.PopBack();
+        v.Clear();
+        assert(v.Size() == 0);
+        v.Swap(v_moved);
+        assert(v.Size() == 20 && v_moved.Size() == 0);
+        std::sort(v.begin(), v.end());
+        assert(v[0].empty() && v[19] == v_copy[19]);
+    }
+    {
+        Obj::ResetCounters();
+        SegmentedVector<Obj> v;
+        for (int i = 0; i < 100; ++i) {
+            v.EmplaceBack(i);
+        }
+        assert(Obj::num_moved == 0 && Obj::num_copied == 0);
+        v.PopBack();
+        assert(Obj::GetAliveObjectCount() == 99);
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+}
+
+void Test25() {
+    static_assert(std::random_access_iterator<SoAVector<int, double>::iterator>);
+    static_assert(std::is_same_v<SoAVector<int, double>::reference, std::tuple<int&, double&>>);
+    {
+        SoAVector<int, double, std::string> v;
+        for (int i = 0; i < 100; ++i) {
+            v.EmplaceBack(i, i * 0.5, std::to_string(i));
+        }
+        assert(v.Size() == 100 && v.Capacity() >= 100);
+
+        const std::span<int> ids = v.Column<0>();
+        assert(ids.size() == 100 && &ids[1] == &ids[0] + 1);
+        assert(std::accumulate(ids.begin(), ids.end(), 0) == 99 * 100 / 2);
+        const auto [id, weight, name] = v[42];
+        assert(id == 42 && weight == 21.0 && name == "42");
+
+        v.Erase(v.begin() + 10);
+        assert(v.Size() == 99 && std::get<0>(v[10]) == 11 && std::get<2>(v[98]) == "99");
+        v.PopBack();
+        v.PushBack({-1, -1.0, "last"});
+        assert(std::get<2>(v[98]) == "last");
+
+        double total = 0;
+        for (auto [i, w, n] : v) {
+            w *= 2;
+            total += w;
+        }
+        assert(total == 2 * std::accumulate(v.Column<1>().begin(), v.Column<1>().end(), 0.0) / 2);
+        assert(std::get<1>(v[1]) == 1.0);
+
+        const SoAVector<int, double, std::string> v_copy(v);
+        assert(v_copy.Size() == 99 && std::get<2>(v_copy[98]) == "last");
+        assert(v_copy.begin() + 99 == v_copy.end() && v_copy.cend() - v_copy.cbegin() == 99);
+
+        SoAVector<int, double, std::string> v_moved(std::move(v));
+        assert(v.Size() == 0 && v_moved.Size() == 99);
+        v = v_copy;
+        assert(v.Size() == 99 && std::get<0>(v[0]) == 0);
+        v.Clear();
+        v.Swap(v_moved);
+        assert(v.Size() == 99 && v_moved.Size() == 0);
+
+        v.Reserve(1000);
+        assert(v.Capacity() == 1000 && std::get<2>(v[98]) == "last");
+        v.Resize(2);
+        assert(v.Size() == 2);
+        v.EmplaceBack(std::get<0>(v[0]), std::get<1>(v[0]), std::get<2>(v[1]));
+        assert(std::get<2>(v[2]) == std::get<2>(v[1]));
+    }
+    {
+        SoAVector<std::tuple<int, std::string>> v(3);
+        assert(v.Size() == 3 && std::get<0>(v[2]) == 0 && std::get<1>(v[2]).empty());
+        v.EmplaceBack(7, "a string that does not fit into SSO");
+        while (v.Size() < v.Capacity()) {
+            v.EmplaceBack(std::get<0>(v[3]), std::get<1>(v[3]));
+        }
+        // Growing must keep the arguments alive while the columns move
+        v.EmplaceBack(std::get<0>(v[3]), std::get<1>(v[3]));
+        assert(std::get<1>(v[v.Size() - 1]) == std::get<1>(v[3]));
+    }
+    {
+        Obj::ResetCounters();
+        SoAVector<int, Obj> v(4);
+        Obj::default_construction_throw_countdown = 2;
+        try {
+            v.Resize(10);
+            assert(false);
+        }
+        catch (const std::runtime_error&) {
+        }
+        assert(v.Size() == 5 && Obj::GetAliveObjectCount() == 5);
+
+        std::get<1>(v[0]).throw_on_copy = true;
+        try {
+            SoAVector<int, Obj> v_copy(v);
+            assert(false);
+        }
+        catch (const std::runtime_error&) {
+        }
+        assert(Obj::GetAliveObjectCount() == 5);
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+}
+
+template <typename T>
+void CheckSimdAlgorithms() {
+    // Sizes around the vector widths exercise the scalar head and tail paths
+    for (size_t size : {1, 2, 15, 16, 17, 63, 64, 65, 255, 256, 257, 1000, 4099}) {
+        Vector<T> v(size);
+        for (size_t i = 0; i < size; ++i) {
+            v[i] = static_cast<T>((i * 7) % 100);
+        }
+        v[size / 2] = static_cast<T>(120);
+        v[size - 1] = static_cast<T>(1);
+
+        assert(Find(v, T(120)) == std::find(v.begin(), v.end(), T(120)));
+        assert(Find(v, T(1)) == std::find(v.begin(), v.end(), T(1)));
+        assert(Find(v, T(121)) == v.end());
+        assert(Count(v, T(1)) == static_cast<size_t>(std::count(v.begin(), v.end(), T(1))));
+        assert(Count(v, T(120)) == static_cast<size_t>(std::count(v.begin(), v.end(), T(120))));
+
+        SumType<T> expected = 0;
+        for (const T& value : v) {
+            expected += value;
+        }
+        assert(Sum(v) == expected);
+
+        const auto [lowest, highest] = MinMax(v);
+        assert(lowest == *std::min_element(v.begin(), v.end()) && highest == *std::max_element(v.begin(), v.end()));
+    }
+}
+
+void Test26() {
+    CheckSimdAlgorithms<int8_t>();
+    CheckSimdAlgorithms<uint8_t>();
+    CheckSimdAlgorithms<int16_t>();
+    CheckSimdAlgorithms<int32_t>();
+    CheckSimdAlgorithms<uint32_t>();
+    CheckSimdAlgorithms<int64_t>();
+    CheckSimdAlgorithms<float>();
+    CheckSimdAlgorithms<double>();
+    {
+        // The counts of 8-bit lanes are flushed before they overflow
+        const Vector<int8_t> v(100000, DefaultInit);
+        Vector<int8_t> ones(v.Size());
+        std::fill(ones.begin(), ones.end(), int8_t(1));
+        assert(Count(ones, 1) == 100000 && Sum(ones) == 100000);
+        Vector<uint32_t> big(1000);
+        std::fill(big.begin(), big.end(), std::numeric_limits<uint32_t>::max());
+        assert(Sum(big) == 1000ull * std::numeric_limits<uint32_t>::max());
+    }
+    {
+        SoAVector<int, float> soa;
+        for (int i = 0; i < 100; ++i) {
+            soa.EmplaceBack(i, 0.5f);
+        }
+        assert(Sum(soa.Column<0>()) == 99 * 100 / 2 && Sum(soa.Column<1>()) == 50.0f);
+        assert(Find(soa.Column<0>(), 42) == &std::get<0>(soa[42]));
+    }
+    {
+        Vector<int> a(300);
+        std::iota(a.begin(), a.end(), 0);
+        SmallVector<int, 4> b;
+        b.Append(a.begin(), a.end());
+        assert(a == b && !(a != b) && (a <=> b) == std::strong_ordering::equal);
+        b[290] = -1;
+        assert(a != b && a > b && b < a);
+        b.PopBack();
+        b[290] = 290;
+        assert(b < a && a >= b);
+
+        Vector<unsigned char> bytes(3);
+        Vector<unsigned char> longer(4);
+        assert(bytes < longer);
+        bytes[2] = 200;
+        assert(bytes > longer);
+
+        Vector<std::string> strings(2);
+        Vector<std::string> strings_copy(strings);
+        assert(strings == strings_copy);
+        strings_copy[1] = "b";
+        assert(strings < strings_copy && (strings <=> strings_copy) == std::strong_ordering::less);
+
+        Vector<double> doubles(1);
+        Vector<double> other_doubles(1);
+        other_doubles[0] = -0.0;
+        assert(doubles == other_doubles && (doubles <=> other_doubles) == std::partial_ordering::equivalent);
+    }
+}
+
+template <typename VectorType>
+void CheckMergeInsert(size_t size, size_t count, size_t capacity) {
+    using T = std::remove_cvref_t<decltype(*std::declval<VectorType&>().begin())>;
+    const auto make = [](size_t i) {
+        if constexpr (std::is_same_v<T, std::string>) {
+            return "a string that does not fit into SSO #" + std::to_string(1000 + i);
+        }
+        else {
+            return static_cast<T>(i);
+        }
+    };
+
+    VectorType v;
+    v.Reserve(capacity);
+    std::vector<T> expected;
+    for (size_t i = 0; i < size; ++i) {
+        v.PushBack(make(i * 3 % 997));
+        expected.push_back(make(i * 3 % 997));
+    }
+    std::sort(v.begin(), v.end());
+    std::sort(expected.begin(), expected.end());
+
+    std::vector<T> incoming;
+    for (size_t i = 0; i < count; ++i) {
+        incoming.push_back(make(i * 7 % 1009));
+    }
+    std::sort(incoming.begin(), incoming.end());
+    expected.insert(expected.end(), incoming.begin(), incoming.end());
+    std::inplace_merge(expected.begin(), expected.end() - count, expected.end());
+
+    v.MergeInsert(incoming.begin(), incoming.end());
+    assert(v.Size() == expected.size() && std::equal(v.begin(), v.end(), expected.begin()));
+}
+
+void Test27() {
+    for (const auto& [size, count, capacity] : {std::tuple{0, 5, 0}, {5, 0, 0}, {100, 10, 0}, {100, 10, 200}, {10, 100, 0},
+                                               {10, 100, 500}, {1000, 1, 0}, {1000, 1000, 4000}, {1, 1, 1}}) {
+        CheckMergeInsert<Vector<int>>(size, count, capacity);
+        CheckMergeInsert<Vector<std::string>>(size, count, capacity);
+        CheckMergeInsert<SmallVector<int, 16>>(size, count, capacity);
+        CheckMergeInsert<Vector<int, MallocAllocator<int>>>(size, count, capacity);
+    }
+    {
+        // New elements go after the equal ones, the comparator orders the Vector
+        using Entry = std::pair<int, char>;
+        const auto by_key = [](const Entry& lhs, const Entry& rhs) {
+            return lhs.first > rhs.first;
+        };
+        Vector<Entry> v;
+        v.PushBack(Entry{5, 'a'});
+        v.PushBack(Entry{3, 'a'});
+        v.PushBack(Entry{1, 'a'});
+        const Entry incoming[] = {{5, 'b'}, {4, 'b'}, {1, 'b'}, {0, 'b'}};
+        v.MergeInsert(std::begin(incoming), std::end(incoming), by_key);
+        const Entry expected[] = {{5, 'a'}, {5, 'b'}, {4, 'b'}, {3, 'a'}, {1, 'a'}, {1, 'b'}, {0, 'b'}};
+        assert(std::equal(v.begin(), v.end(), std::begin(expected), std::end(expected)));
+
+        assert(v.InsertSorted(Entry{3, 'c'}, by_key) == v.begin() + 4);
+        assert(v[3] == Entry(3, 'a') && v[4] == Entry(3, 'c'));
+    }
+    {
+        std::istringstream input("2 4 6 8");
+        Vector<int> v;
+        v.PushBack(1);
+        v.PushBack(5);
+        v.MergeInsert(std::istream_iterator<int>(input), std::istream_iterator<int>());
+        const int expected[] = {1, 2, 4, 5, 6, 8};
+        assert(std::equal(v.begin(), v.end(), std::begin(expected), std::end(expected)));
+        v.InsertSorted(3);
+        v.InsertSorted(9);
+        v.InsertSorted(0);
+        assert(std::is_sorted(v.begin(), v.end()) && v.Size() == 9 && v[0] == 0 && v[8] == 9);
+    }
+    {
+        // Move iterators over a Vector are multi-pass, so the size is known up front
+        Vector<std::string> source(100);
+        Vector<std::string> target;
+        target.Append(std::make_move_iterator(source.begin()), std::make_move_iterator(source.end()));
+        assert(target.Size() == 100 && target.Capacity() == 100);
+    }
+    {
+        const auto by_id = [](const Obj& lhs, const Obj& rhs) {
+            return lhs.id < rhs.id;
+        };
+        Obj::ResetCounters();
+        Vector<Obj> v;
+        v.Reserve(200);
+        for (int i = 0; i < 100; ++i) {
+            v.EmplaceBack(i * 2);
+        }
+        Vector<Obj> incoming;
+        for (int i = 0; i < 100; ++i) {
+            incoming.EmplaceBack(i * 2 + 1);
+        }
+
+        // Copying in may throw, so the range is staged first: k copies, at most n + k moves, no reallocation
+        Obj::ResetCounters();
+        v.MergeInsert(incoming.begin(), incoming.end(), by_id);
+        assert(Obj::num_copied == 100 && Obj::num_moved <= 200);
+        assert(v.Size() == 200 && v.Capacity() == 200);
+        for (int i = 0; i < 200; ++i) {
+            assert(v[i].id == i);
+        }
+
+        incoming[50].throw_on_copy = true;
+        try {
+            v.MergeInsert(incoming.begin(), incoming.end(), by_id);
+            assert(false);
+        }
+        catch (const std::runtime_error&) {
+        }
+        assert(v.Size() == 200 && v[199].id == 199);
+    }
+    {
+        // A throwing comparator leaves the Vector unchanged, on the bitwise, the assigning and the reallocating paths
+        const auto check = [](auto make, size_t capacity) {
+            using V = decltype(make({}));
+            for (int throw_at = 0;; ++throw_at) {
+                V v = make({1, 3, 5});
+                v.Reserve(capacity);
+                V incoming = make({2, 4});
+                const auto* data = v.begin();
+                int comparisons = 0;
+                const auto comp = [&](const auto& lhs, const auto& rhs) {
+                    if (comparisons++ == throw_at) {
+                        throw std::runtime_error("Oops");
+                    }
+                    return *lhs < *rhs;
+                };
+                try {
+                    v.MergeInsert(std::make_move_iterator(incoming.begin()), std::make_move_iterator(incoming.end()), comp);
+                    assert(v.Size() == 5);
+                    for (int i = 0; i < 5; ++i) {
+                        assert(*v[i] == i + 1);
+                    }
+                    break;
+                }
+                catch (const std::runtime_error&) {
+                    assert(v.Size() == 3 && v.begin() == data);
+                    assert(*v[0] == 1 && *v[1] == 3 && *v[2] == 5);
+                    assert(*incoming[0] == 2 && *incoming[1] == 4);
+                }
+            }
+        };
+        const auto make_pointers = [](std::initializer_list<int> values) {
+            Vector<std::unique_ptr<int>> v;
+            for (int value : values) {
+                v.EmplaceBack(std::make_unique<int>(value));
+            }
+            return v;
+        };
+        const auto make_shared_pointers = [](std::initializer_list<int> values) {
+            Vector<std::shared_ptr<int>> v;
+            for (int value : values) {
+                v.EmplaceBack(std::make_shared<int>(value));
+            }
+            return v;
+        };
+        check(make_pointers, 8);
+        check(make_pointers, 3);
+        check(make_shared_pointers, 8);
+        check(make_shared_pointers, 3);
+    }
+    {
+        // A copy that throws midway moves the memmoved runs back down
+        const auto by_id = [](const ThrowingRelocatableObj& lhs, const ThrowingRelocatableObj& rhs) {
+            return lhs.id < rhs.id;
+        };
+        for (int throw_at = 0; throw_at < 3; ++throw_at) {
+            {
+                Vector<ThrowingRelocatableObj> v;
+                v.Reserve(8);
+                for (int id : {1, 3, 5, 7}) {
+                    v.EmplaceBack(id);
+                }
+                Vector<ThrowingRelocatableObj> incoming;
+                for (int id : {2, 4, 6}) {
+                    incoming.EmplaceBack(id);
+                }
+                incoming[throw_at].throw_on_copy = true;
+                try {
+                    v.MergeInsert(incoming.begin(), incoming.end(), by_id);
+                    assert(false);
+                }
+                catch (const std::runtime_error&) {
+                }
+                assert(v.Size() == 4 && v.Capacity() == 8);
+                assert(v[0].id == 1 && v[1].id == 3 && v[2].id == 5 && v[3].id == 7);
+            }
+            assert(ThrowingRelocatableObj::num_alive == 0);
+        }
+    }
+}
+
+void Test28() {
+    {
+        for (size_t size = 0; size < 40; ++size) {
+            Vector<int> keys(size);
+            for (size_t i = 0; i < size; ++i) {
+                keys[i] = static_cast<int>(i / 2 * 2);
+            }
+            for (int key = -1; key <= static_cast<int>(size) + 1; ++key) {
+                assert(detail::BranchlessLowerBound(keys.begin(), size, key, std::less<>()) == size_t(std::lower_bound(keys.begin(), keys.end(), key) - keys.begin()));
+                assert(detail::BranchlessUpperBound(keys.begin(), size, key, std::less<>()) == size_t(std::upper_bound(keys.begin(), keys.end(), key) - keys.begin()));
+            }
+        }
+    }
+    {
+        FlatSet<int> set = {5, 1, 4, 1, 5, 9, 2, 6};
+        const int expected[] = {1, 2, 4, 5, 6, 9};
+        assert(std::equal(set.begin(), set.end(), std::begin(expected), std::end(expected)));
+        assert(set.Contains(4) && !set.Contains(3) && set.Find(9) == set.end() - 1 && set.Find(10) == set.end());
+        assert(*set.LowerBound(3) == 4 && *set.UpperBound(4) == 5);
+
+        assert(set.Insert(3).second && !set.Insert(3).second && set.Size() == 7);
+        assert(set.Erase(1) == 1 && set.Erase(1) == 0);
+        const int more[] = {8, 0, 4, 8, 7};
+        set.Insert(std::begin(more), std::end(more));
+        const int merged[] = {0, 2, 3, 4, 5, 6, 7, 8, 9};
+        assert(std::equal(set.begin(), set.end(), std::begin(merged), std::end(merged)));
+        set.Erase(set.begin());
+        assert(*set.begin() == 2);
+
+        const FlatSet<int> sorted(SortedUnique, std::begin(merged), std::end(merged));
+        assert(sorted.Size() == 9 && sorted.Keys()[0] == 0);
+        FlatSet<int> copy = sorted;
+        assert(copy == sorted);
+        copy.Insert(100);
+        assert(!(copy == sorted));
+    }
+    {
+        FlatSet<std::string, std::less<>> names = {"b", "a", "c"};
+        assert(names.Contains(std::string_view("b")) && names.Erase("a") == 1 && names.Size() == 2);
+    }
+    {
+        FlatMap<std::string, int> map = {{"three", 3}, {"one", 1}, {"two", 2}, {"one", 100}};
+        assert(map.Size() == 3 && map.At("one") == 1);
+        assert(std::is_sorted(map.Keys().begin(), map.Keys().end()));
+        assert((*map.begin()).first == "one" && (*map.begin()).second == 1);
+
+        map["four"] = 4;
+        assert(map.Size() == 4 && map.At("four") == 4);
+        ++map["one"];
+        assert(map.At("one") == 2);
+        assert(!map.TryEmplace("two", 200).second && map.At("two") == 2);
+        assert(!map.InsertOrAssign("two", 22).second && map.At("two") == 22);
+        assert(map.Insert({"five", 5}).second);
+
+        try {
+            map.At("six");
+            assert(false);
+        }
+        catch (const std::out_of_range&) {
+        }
+
+        int total = 0;
+        for (auto [key, value] : map) {
+            total += value;
+            value = 0;
+        }
+        assert(total == 4 + 2 + 22 + 5 + 3 && map.At("three") == 0);
+
+        const std::pair<std::string, int> more[] = {{"zero", 0}, {"one", -1}, {"ten", 10}, {"zero", -1}};
+        map.Insert(std::begin(more), std::end(more));
+        assert(map.Size() == 7 && map.At("one") == 0 && map.At("zero") == 0 && map.At("ten") == 10);
+        assert(std::is_sorted(map.Keys().begin(), map.Keys().end()));
+
+        assert(map.Erase("ten") == 1 && !map.Contains("ten"));
+        const auto next = map.Erase(map.Find("five"));
+        assert((*next).first == "four" && map.Size() == 5);
+        assert(map.LowerBound("p") == map.Find("three") && map.UpperBound("two") == map.Find("zero") && map.UpperBound("zero") == map.end());
+
+        const FlatMap<std::string, int>& const_map = map;
+        assert(const_map.Find("two") != const_map.end() && (*const_map.Find("two")).second == 0);
+        assert(const_map.Values().Size() == 5);
+    }
+    {
+        Obj::ResetCounters();
+        FlatMap<int, Obj> map;
+        map.TryEmplace(1, 1);
+        map.TryEmplace(2, 2);
+        Obj::default_construction_throw_countdown = 1;
+        try {
+            map[3];
+            assert(false);
+        }
+        catch (const std::runtime_error&) {
+        }
+        assert(map.Size() == 2 && map.Keys().Size() == 2 && !map.Contains(3));
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+}
+
+void Test29() {
+    {
+        CowVector<int> table = {1, 2, 3};
+        const int* buffer = table.begin();
+        CowVector<int> copy = table;
+        assert(copy.begin() == buffer && table.UseCount() == 2 && copy == table);
+
+        copy.PushBack(4);
+        assert(copy.begin() != buffer && table.begin() == buffer);
+        assert(table.UseCount() == 1 && copy.UseCount() == 1);
+        assert(table.Size() == 3 && copy.Size() == 4 && copy[3] == 4 && !(copy == table));
+
+        // A unique CowVector mutates in place.
+        table.Mutate()[0] = 10;
+        assert(table.begin() == buffer && table[0] == 10);
+
+        CowVector<int> shared = table;
+        shared.Clear();
+        assert(shared.Size() == 0 && shared.UseCount() == 0 && table.Size() == 3 && table.UseCount() == 1);
+
+        CowVector<int> moved = std::move(table);
+        assert(moved.begin() == buffer && table.Size() == 0 && table.UseCount() == 0);
+        table = moved;
+        assert(table.begin() == buffer && moved.UseCount() == 2);
+    }
+    {
+        Vector<std::string> source;
+        source.PushBack("a");
+        source.PushBack("b");
+        const std::string* buffer = source.begin();
+        const CowVector<std::string> strings(std::move(source));
+        assert(strings.begin() == buffer && strings.Size() == 2 && strings.View()[1] == "b");
+
+        CowVector<std::string> copy = strings;
+        copy.EmplaceBack("c");
+        copy.PopBack();
+        assert(copy == strings && copy.begin() != strings.begin());
+    }
+    {
+        // A failed copy on first mutation leaves the elements shared and unchanged.
+        Obj::ResetCounters();
+        CowVector<Obj> objects;
+        objects.Mutate().Resize(4);
+        objects.Mutate()[2].throw_on_copy = true;
+        CowVector<Obj> copy = objects;
+        try {
+            copy.EmplaceBack();
+            assert(false);
+        }
+        catch (const std::runtime_error&) {
+        }
+        assert(copy.UseCount() == 2 && copy.Size() == 4 && copy.begin() == objects.begin());
+        assert(Obj::GetAliveObjectCount() == 4);
+    }
+    {
+        // Readers share one table while a writer publishes modified copies of its own.
+        CowVector<int> table;
+        table.Mutate().Resize(256);
+        std::vector<std::thread> readers;
+        std::atomic<size_t> sum = 0;
+        for (int t = 0; t < 4; ++t) {
+            readers.emplace_back([&sum, snapshot = table] {
+                for (int round = 0; round < 100; ++round) {
+                    CowVector<int> local = snapshot;
+                    sum += std::accumulate(local.begin(), local.end(), size_t(0)) + local.Size();
+                }
+            });
+        }
+        for (int round = 0; round < 100; ++round) {
+            CowVector<int> next = table;
+            next.Mutate()[round] = 0;
+            table = std::move(next);
+        }
+        for (auto& reader : readers) {
+            reader.join();
+        }
+        assert(sum == 4 * 100 * 256 && table.UseCount() == 1);
+    }
+}
+
+void Test30() {
+    {
+        // Random operations checked against std::vector models, keeping older versions alive as snapshots.
+        std::mt19937 rng(7);
+        PersistentVector<int> current;
+        std::vector<int> model;
+        std::vector<std::pair<PersistentVector<int>, std::vector<int>>> versions;
+        for (int step = 0; step < 20000; ++step) {
+            const unsigned op = rng() % 10;
+            if (op < 6 || model.empty()) {
+                current.PushBack(step);
+                model.push_back(step);
+            }
+            else if (op < 9) {
+                const size_t index = rng() % model.size();
+                current.Set(index, -step);
+                model[index] = -step;
+            }
+            else {
+                current.PopBack();
+                model.pop_back();
+            }
+            if (step % 997 == 0) {
+                versions.emplace_back(current, model);
+            }
+        }
+        assert(current.Size() == model.size() && std::equal(current.begin(), current.end(), model.begin(), model.end()));
+        for (const auto& [version, expected] : versions) {
+            assert(version.Size() == expected.size() && std::equal(version.begin(), version.end(), expected.begin(), expected.end()));
+            for (size_t i = 0; i < expected.size(); i += 37) {
+                assert(version[i] == expected[i]);
+            }
+        }
+
+        // Popping everything walks the trie back down to the tail.
+        PersistentVector<int> drained = current;
+        while (drained.Size() > 0) {
+            drained.PopBack();
+        }
+        assert(current.Size() == model.size() && std::equal(current.begin(), current.end(), model.begin()));
+
+        // More than 32^3 elements need three levels of inner nodes above the leaves.
+        PersistentVector<int> deep;
+        for (int i = 0; i < 40000; ++i) {
+            deep.PushBack(i);
+        }
+        PersistentVector<int> deep_snapshot = deep;
+        for (int i = 40000; i-- > 0;) {
+            assert(deep[i] == i);
+            deep.PopBack();
+        }
+        assert(deep.Size() == 0 && deep_snapshot.Size() == 40000 && deep_snapshot[32767] == 32767 && deep_snapshot[39999] == 39999);
+    }
+    {
+        PersistentVector<std::string> names = {"a", "b", "c"};
+        PersistentVector<std::string> snapshot = names;
+        assert(snapshot == names);
+        names.Set(1, "B");
+        names.PushBack("d");
+        assert(snapshot.Size() == 3 && snapshot[1] == "b" && names.Size() == 4 && names[1] == "B" && !(snapshot == names));
+
+        size_t chunks = 0;
+        size_t total = 0;
+        PersistentVector<size_t> numbers;
+        for (size_t i = 0; i < 100; ++i) {
+            numbers.PushBack(i);
+        }
+        numbers.ForEachChunk([&](const size_t* first, size_t count) {
+            ++chunks;
+            total += std::accumulate(first, first + count, size_t(0));
+        });
+        assert(chunks == 4 && total == 99 * 100 / 2);
+    }
+    {
+        // Only the path to a changed element is copied, the rest stays shared.
+        PersistentVector<int> base;
+        for (int i = 0; i < 2000; ++i) {
+            base.PushBack(i);
+        }
+        PersistentVector<int> next = base;
+        next.Set(5, -5);
+        assert(&base[1000] == &next[1000] && &base[5] != &next[5] && &base[6] != &next[6] && base[5] == 5);
+        // The path is private now, so further updates to the same leaf work in place.
+        const int* slot = &next[6];
+        next.Set(6, -6);
+        assert(&next[6] == slot && next[6] == -6);
+    }
+    {
+        // A failing copy of a shared leaf leaves both versions unchanged.
+        Obj::ResetCounters();
+        {
+            PersistentVector<Obj> objects;
+            for (int i = 0; i < 40; ++i) {
+                objects.EmplaceBack(i);
+            }
+            PersistentVector<Obj> copy = objects;
+            Obj thrower(100);
+            thrower.throw_on_copy = true;
+            objects.Set(4, thrower);
+            try {
+                copy = objects;
+                copy.Set(0, Obj(0));
+                assert(false);
+            }
+            catch (const std::runtime_error&) {
+            }
+            assert(copy.Size() == 40 && copy[0].id == 0 && copy[4].id == 100);
+        }
+        assert(Obj::GetAliveObjectCount() == 0);
+    }
+}
+
+void Test31() {
+    using PooledInts = Vector<int, PoolAllocator<int>>;
+    ThreadBlockPool& pool = *ThreadBlockPool::Local();
+    {
+        PooledInts v;
+        v.Reserve(5);
+        assert(v.Capacity() == 8);
+        v.Reserve(100);
+        assert(v.Capacity() == 128);
+        static_assert(PoolAllocator<int>::round_capacity(0) == 0 && PoolAllocator<int>::round_capacity(3) == 4);
+        static_assert(PoolAllocator<std::array<char, 24>>::round_capacity(1) == 1 && PoolAllocator<std::array<char, 24>>::round_capacity(3) == 5);
+        static_assert(PoolAllocator<char>::round_capacity(ThreadBlockPool::kMaxBlockBytes + 1) == ThreadBlockPool::kMaxBlockBytes + 1);
+    }
+    {
+        // After the first round every allocation is served from the cache.
+        auto handle_request = [] {
+            PooledInts v;
+            for (int i = 0; i < 100; ++i) {
+                v.PushBack(i);
+            }
+            Vector<std::string, PoolAllocator<std::string>> names(3);
+            names[0] = "request";
+            return v[99] + int(names.Size());
+        };
+        handle_request();
+        const PoolStats before = pool.GetStats();
+        for (int round = 0; round < 1000; ++round) {
+            assert(handle_request() == 102);
+        }
+        const PoolStats after = pool.GetStats();
+        assert(after.misses == before.misses && after.hits > before.hits && after.cached_bytes == before.cached_bytes);
+
+        pool.Trim(64);
+        assert(pool.GetStats().cached_bytes <= 64);
+        pool.Trim();
+        assert(pool.GetStats().cached_bytes == 0);
+    }
+    {
+        // Without room in the cache, freed blocks go back to the heap.
+        const PoolLimits limits = pool.GetLimits();
+        pool.SetLimits({.max_cached_bytes = 0, .max_block_bytes = limits.max_block_bytes});
+        {
+            PooledInts v(10);
+        }
+        assert(pool.GetStats().cached_bytes == 0);
+        pool.SetLimits({.max_cached_bytes = limits.max_cached_bytes, .max_block_bytes = 64});
+        {
+            PooledInts small(16);
+            PooledInts large(17);
+        }
+        assert(pool.GetStats().cached_bytes == 64);
+        pool.SetLimits(limits);
+        pool.Trim();
+    }
+    {
+        // Every thread has its own pool, and a block joins the pool of the thread freeing it.
+        PooledInts v(1000);
+        size_t cached_on_worker = 0;
+        size_t misses_on_worker = 0;
+        std::thread worker([&] {
+            PooledInts local(std::move(v));
+            local.Clear();
+            local.ShrinkToFit();
+            const PoolStats stats = ThreadBlockPool::Local()->GetStats();
+            cached_on_worker = stats.cached_bytes;
+            misses_on_worker = stats.misses;
+        });
+        worker.join();
+        assert(cached_on_worker == 4096 && misses_on_worker == 0 && pool.GetStats().cached_bytes == 0);
+    }
+}
+
+void Test32() {
+    static_assert(sizeof(CompactVector<int>) == sizeof(void*) && sizeof(CompactVector<std::string>) == sizeof(void*));
+    {
+        CompactVector<int> v;
+        assert(v.Size() == 0 && v.Capacity() == 0 && v.begin() == nullptr);
+        std::vector<int> model;
+        for (int i = 0; i < 100; ++i) {
+            v.PushBack(i);
+            model.push_back(i);
+        }
+        v.Insert(v.begin() + 10, -1);
+        model.insert(model.begin() + 10, -1);
+        v.Emplace(v.end(), -2);
+        model.push_back(-2);
+        v.Erase(v.begin() + 20, v.begin() + 30);
+        model.erase(model.begin() + 20, model.begin() + 30);
+        const int more[] = {7, 8, 9};
+        v.Insert(v.begin() + 5, std::begin(more), std::end(more));
+        model.insert(model.begin() + 5, std::begin(more), std::end(more));
+        v.PopBack();
+        model.pop_back();
+        assert(std::equal(v.begin(), v.end(), model.begin(), model.end()));
+
+        // The argument may refer to an element that moves when the vector grows.
+        v.ShrinkToFit();
+        assert(v.Capacity() == v.Size());
+        v.EmplaceBack(v[0]);
+        assert(v[v.Size() - 1] == model[0]);
+
+        v.Resize(3);
+        assert(v.Size() == 3 && v[2] == model[2]);
+        v.Resize(5);
+        assert(v[3] == 0 && v[4] == 0);
+        v.Clear();
+        v.ShrinkToFit();
+        assert(v.begin() == nullptr);
+    }
+    {
+        CompactVector<std::string> a = {"a", "b", "c"};
+        CompactVector<std::string> b = a;
+        assert(a == b && !(a < b));
+        b.PushBack("d");
+        assert(a < b && a != b);
+        const std::string* buffer = b.begin();
+        b = a;
+        assert(b == a && b.begin() == buffer);
+        CompactVector<std::string> c = std::move(b);
+        assert(b.Size() == 0 && b.begin() == nullptr && c == a);
+        c.Emplace(c.begin(), "z");
+        assert(c[0] == "z" && c[3] == "c" && c > a);
+        a.Swap(c);
+        assert(a.Size() == 4 && c.Size() == 3);
+    }
+    {
+        // Over-aligned elements start at their alignment after the header.
+        struct alignas(32) Wide {
+            int value = 0;
+        };
+        CompactVector<Wide> wide(3);
+        assert(reinterpret_cast<uintptr_t>(wide.begin()) % 32 == 0 && wide[2].value == 0);
+    }
+    {
+        // A throwing constructor while growing leaves the elements unchanged.
+        Obj::ResetCounters();
+        {
+            CompactVector<Obj> objects;
+            for (int i = 0; i < 4; ++i) {
+                objects.EmplaceBack(i);
+            }
+            Obj::default_construction_throw_countdown = 1;
+            try {
+                objects.EmplaceBack();
+                assert(false);
+            }
+            catch (const std::runtime_error&) {
+            }
+            assert(objects.Size() == 4 && objects.Capacity() == 4 && objects[3].id == 3);
+            Obj::default_construction_throw_countdown = 3;
+            try {
+                objects.Resize(10);
+                assert(false);
+            }
+            catch (const std::runtime_error&) {
+            }
+            assert(objects.Size() == 4 && objects[0].id == 0);
+        }
+        assert(Obj::GetAliveObjectCount() == 0);
+    }
+    {
+        CompactVector<char> bytes;
+        try {
+            bytes.Reserve(CompactVector<char>::kMaxSize + size_t(1));
+            assert(false);
+        }
+        catch (const std::length_error&) {
+        }
+        assert(bytes.Capacity() == 0);
+    }
+}
+
+template <size_t Bits>
+void CheckPackedIntVector() {
+    std::mt19937_64 rng(Bits);
+    PackedIntVector<Bits> packed;
+    std::vector<uint64_t> model;
+    for (size_t i = 0; i < 1000; ++i) {
+        const uint64_t value = rng() & PackedIntVector<Bits>::kMaxValue;
+        packed.PushBack(value);
+        model.push_back(value);
+    }
+    assert(packed.Words().size() == (1000 * Bits + 63) / 64);
+    for (size_t i = 0; i < model.size(); i += 7) {
+        const uint64_t value = rng() & PackedIntVector<Bits>::kMaxValue;
+        packed.Set(i, value);
+        model[i] = value;
+    }
+    for (size_t i = 0; i < model.size(); ++i) {
+        assert(packed[i] == model[i]);
+    }
+    for (size_t first : {size_t(0), size_t(1), size_t(63), size_t(100)}) {
+        std::vector<uint64_t> out(model.size() - first);
+        packed.Unpack(first, out.size(), out.data());
+        assert(std::equal(out.begin(), out.end(), model.begin() + first));
+    }
+
+    PackedIntVector<Bits> copy;
+    copy.Append(model.data(), model.size());
+    assert(copy == packed);
+    copy.Resize(10);
+    packed.Resize(10);
+    assert(copy == packed && copy[9] == model[9]);
+    copy.Resize(20);
+    assert(copy[15] == 0);
+}
+
+void Test33() {
+    {
+        BitVector<> bits;
+        std::vector<bool> model;
+        std::mt19937 rng(3);
+        for (size_t i = 0; i < 1000; ++i) {
+            const bool value = rng() % 3 == 0;
+            bits.PushBack(value);
+            model.push_back(value);
+        }
+        bits.AppendBits(0b1011, 4);
+        model.insert(model.end(), {true, true, false, true});
+        bits.AppendBits(~uint64_t(0), 64);
+        model.insert(model.end(), 64, true);
+        assert(bits.Size() == model.size());
+
+        size_t count = 0;
+        std::vector<size_t> set_bits;
+        for (size_t i = 0; i < model.size(); ++i) {
+            assert(bits[i] == model[i]);
+            assert(bits.Rank(i) == count);
+            if (model[i]) {
+                assert(bits.Select(count) == i);
+                set_bits.push_back(i);
+                ++count;
+            }
+        }
+        assert(bits.Count() == count && bits.Rank(bits.Size()) == count && bits.Select(count) == bits.Size());
+
+        std::vector<size_t> visited;
+        bits.ForEachSetBit([&visited](size_t index) { visited.push_back(index); });
+        assert(visited == set_bits);
+
+        BitVector<> inverse = bits;
+        inverse.FlipAll();
+        assert(inverse.Count() == bits.Size() - count && inverse[0] == !bits[0]);
+        BitVector<> both = bits;
+        both &= inverse;
+        assert(both.None());
+        both = bits;
+        both |= inverse;
+        assert(both.All() && both.Count() == bits.Size());
+        both ^= bits;
+        assert(both == inverse);
+        both.AndNot(inverse);
+        assert(both.None());
+
+        bits.Set(5);
+        bits.Reset(6);
+        bits.Flip(7);
+        assert(bits[5] && !bits[6] && bits[7] == !model[7]);
+    }
+    {
+        BitVector<> bits(70, true);
+        assert(bits.Count() == 70 && bits.Words().size() == 2 && bits.Words()[1] == 0x3f);
+        bits.Resize(130, true);
+        assert(bits.Count() == 130);
+        bits.Resize(65);
+        assert(bits.Count() == 65 && bits.Words()[1] == 1);
+        bits.PopBack();
+        assert(bits.Size() == 64 && bits.Words().size() == 1 && bits.All());
+        bits.Resize(100);
+        assert(bits.Count() == 64 && !bits[99]);
+    }
+    CheckPackedIntVector<1>();
+    CheckPackedIntVector<3>();
+    CheckPackedIntVector<8>();
+    CheckPackedIntVector<13>();
+    CheckPackedIntVector<32>();
+    CheckPackedIntVector<63>();
+    CheckPackedIntVector<64>();
+    {
+        PackedIntVector<4> codes(5);
+        codes.Set(2, 15);
+        uint8_t out[5];
+        codes.Unpack(0, 5, out);
+        assert(out[0] == 0 && out[2] == 15 && codes.Words()[0] == 0xf00);
+    }
+}
+
 int main() {
     try {
         Test1();
@@ -387,7 +2676,36 @@ int main() {
         Test3();
         Test4();
         Test5();
+        Test6();
+        Test7();
+        Test8();
+        Test9();
+        Test10();
+        Test11();
+        Test12();
+        Test13();
+        Test14();
+        Test15();
+        Test16();
+        Test17();
+        Test18();
+        Test19();
+        Test20();
+        Test21();
+        Test22();
+        Test23();
+        Test24();
+        Test25();
+        Test26();
+        Test27();
+        Test28();
+        Test29();
+        Test30();
+        Test31();
+        Test32();
+        Test33();
     } catch (const std::exception& e) {
         std::cerr << e.what() << std::endl;
+        return 1;
     }
 }
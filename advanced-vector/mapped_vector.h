@@ -0,0 +1,382 @@
+#pragma once
+
+/**
+ * @file mapped_vector.h
+ * @brief Definition of the MappedVector class, a vector of trivially copyable elements kept in a memory-mapped file.
+ * POSIX only.
+ */
+
+#include "vector.h"
+
+#include <cerrno>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/**
+ * @brief How a MappedVector opens its file.
+ */
+enum class MapMode {
+    OPEN_OR_CREATE, /*< Opens the file for reading and writing, creates an empty one if it does not exist. */
+    TRUNCATE,       /*< Creates the file or discards its content. */
+    READ_ONLY,      /*< Opens an existing file for reading, the pages are shared with other processes mapping it. */
+};
+
+/**
+ * @brief The MappedMemory class is the counterpart of RawMemory whose block is a shared mapping of a file.
+ * The file holds a 64-byte header followed by the elements, so the capacity is the number of elements
+ * the file has room for and growing the block extends the file.
+ */
+template <typename T>
+class MappedMemory {
+    static_assert(alignof(T) <= 64, "The elements follow a 64-byte header");
+
+    public:
+        /**
+         * @brief Opens and maps a file, validating its header.
+         * Throws std::system_error if a system call fails and std::runtime_error if the file holds other elements.
+         * @param path The path of the file.
+         * @param mode How to open the file.
+         */
+        MappedMemory(const std::string& path, MapMode mode) : read_only_(mode == MapMode::READ_ONLY) {
+            const int flags = read_only_ ? O_RDONLY : O_RDWR | O_CREAT | (mode == MapMode::TRUNCATE ? O_TRUNC : 0);
+            fd_ = ::open(path.c_str(), flags | O_CLOEXEC, 0644);
+            if (fd_ < 0) {
+                throw std::system_error(errno, std::generic_category(), "open " + path);
+            }
+
+            try {
+                struct stat st;
+                Check(::fstat(fd_, &st), "fstat");
+                const size_t file_size = static_cast<size_t>(st.st_size);
+
+                if (file_size == 0 && !read_only_) {
+                    Check(::ftruncate(fd_, kHeaderSize), "ftruncate");
+                    Map(kHeaderSize);
+                    *GetHeader() = Header{kMagic, sizeof(T), alignof(T), 0};
+                }
+                else {
+                    if (file_size < kHeaderSize) {
+                        throw std::runtime_error(path + " is not a MappedVector file");
+                    }
+                    Map(file_size);
+                    const Header& header = *GetHeader();
+                    if (header.magic != kMagic || header.element_size != sizeof(T) || header.element_alignment != alignof(T)) {
+                        throw std::runtime_error(path + " holds elements of another type");
+                    }
+                    if (header.size > Capacity()) {
+                        throw std::runtime_error(path + " is truncated");
+                    }
+                }
+            }
+            catch (...) {
+                Close();
+                throw;
+            }
+        }
+
+        MappedMemory(const MappedMemory&) = delete;
+        MappedMemory& operator=(const MappedMemory&) = delete;
+
+        MappedMemory(MappedMemory&& other) noexcept
+            : fd_(std::exchange(other.fd_, -1))
+            , mapping_(std::exchange(other.mapping_, nullptr))
+            , length_(std::exchange(other.length_, 0))
+            , read_only_(other.read_only_) {}
+
+        MappedMemory& operator=(MappedMemory&& rhs) noexcept {
+            if (this != &rhs) {
+                Close();
+                fd_ = std::exchange(rhs.fd_, -1);
+                mapping_ = std::exchange(rhs.mapping_, nullptr);
+                length_ = std::exchange(rhs.length_, 0);
+                read_only_ = rhs.read_only_;
+            }
+            return *this;
+        }
+
+        ~MappedMemory() {
+            Close();
+        }
+
+        T* operator+(size_t offset) noexcept {
+            assert(offset <= Capacity());
+            return GetAddress() + offset;
+        }
+
+        const T* operator+(size_t offset) const noexcept {
+            return const_cast<MappedMemory&>(*this) + offset;
+        }
+
+        const T& operator[](size_t index) const noexcept {
+            return const_cast<MappedMemory&>(*this)[index];
+        }
+
+        T& operator[](size_t index) noexcept {
+            assert(index < Capacity());
+            return GetAddress()[index];
+        }
+
+        /**
+         * @brief Resizes the file and remaps it, the elements are kept by the file and never copied.
+         * On failure the block is left untouched.
+         * @param new_capacity The new capacity of the block.
+         */
+        void Reallocate(size_t new_capacity) {
+            assert(!read_only_);
+            const size_t new_length = kHeaderSize + new_capacity * sizeof(T);
+
+            if (new_length > length_) {
+                Check(::ftruncate(fd_, new_length), "ftruncate");
+            }
+            void* mapping = ::mmap(nullptr, new_length, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+            if (mapping == MAP_FAILED) {
+                const int error = errno;
+                if (new_length > length_) {
+                    [[maybe_unused]] const int result = ::ftruncate(fd_, length_);
+                }
+                throw std::system_error(error, std::generic_category(), "mmap");
+            }
+
+            ::munmap(mapping_, length_);
+            mapping_ = static_cast<char*>(mapping);
+            if (new_length < length_) {
+                [[maybe_unused]] const int result = ::ftruncate(fd_, new_length);
+            }
+            length_ = new_length;
+        }
+
+        /**
+         * @brief Writes the modified pages to the file and waits for the writes to complete.
+         */
+        void Sync() {
+            Check(::msync(mapping_, length_, MS_SYNC), "msync");
+        }
+
+        /**
+         * @brief Gets the number of elements recorded in the file header.
+         * @return A reference to the recorded size.
+         */
+        uint64_t& StoredSize() noexcept {
+            return GetHeader()->size;
+        }
+
+        uint64_t StoredSize() const noexcept {
+            return const_cast<MappedMemory&>(*this).StoredSize();
+        }
+
+        const T* GetAddress() const noexcept {
+            return const_cast<MappedMemory&>(*this).GetAddress();
+        }
+
+        T* GetAddress() noexcept {
+            return reinterpret_cast<T*>(mapping_ + kHeaderSize);
+        }
+
+        size_t Capacity() const noexcept {
+            return (length_ - kHeaderSize) / sizeof(T);
+        }
+
+        bool IsReadOnly() const noexcept {
+            return read_only_;
+        }
+
+    private:
+        /**
+         * @brief The file header, identifies the element type and records the size.
+         */
+        struct Header {
+            uint64_t magic;
+            uint64_t element_size;
+            uint64_t element_alignment;
+            uint64_t size;
+        };
+
+        static constexpr size_t kHeaderSize = 64;
+        static constexpr uint64_t kMagic = 0x44455050414d5641;  // "AVMAPPED" in little-endian order
+
+        int fd_ = -1;                   /*< The file descriptor. */
+        char* mapping_ = nullptr;       /*< The mapping of the whole file. */
+        size_t length_ = 0;             /*< The length of the mapping, the size of the file. */
+        bool read_only_ = false;        /*< Whether the file is mapped for reading only. */
+
+        static void Check(int result, const char* what) {
+            if (result != 0) {
+                throw std::system_error(errno, std::generic_category(), what);
+            }
+        }
+
+        Header* GetHeader() noexcept {
+            return reinterpret_cast<Header*>(mapping_);
+        }
+
+        void Map(size_t length) {
+            const int protection = read_only_ ? PROT_READ : PROT_READ | PROT_WRITE;
+            void* mapping = ::mmap(nullptr, length, protection, MAP_SHARED, fd_, 0);
+            if (mapping == MAP_FAILED) {
+                throw std::system_error(errno, std::generic_category(), "mmap");
+            }
+            mapping_ = static_cast<char*>(mapping);
+            length_ = length;
+        }
+
+        void Close() noexcept {
+            if (mapping_ != nullptr) {
+                ::munmap(mapping_, length_);
+                mapping_ = nullptr;
+            }
+            if (fd_ >= 0) {
+                ::close(fd_);
+                fd_ = -1;
+            }
+        }
+};
+
+/**
+ * @brief The MappedVector class is a vector of trivially copyable elements stored in a memory-mapped file.
+ * The elements live in the file as they are in memory, so reopening the file makes them available
+ * at once, without reading or deserializing them. The file grows by ftruncate followed by a remap.
+ * The file is not portable between platforms with different type layouts or byte orders.
+ * A READ_ONLY MappedVector must not be modified and is read through its const interface: the mutators and
+ * the non-const accessors assert that the mapping is writable, instead of faulting on its read-only pages.
+ * @tparam Growth The growth policy, see DoublingGrowth.
+ */
+template <typename T, typename Growth = DoublingGrowth<>>
+class MappedVector {
+    static_assert(std::is_trivially_copyable_v<T>, "MappedVector stores the bytes of its elements");
+
+    public:
+        using iterator = T*;
+        using const_iterator = const T*;
+
+        /**
+         * @brief Opens a MappedVector stored in a file.
+         * @param path The path of the file.
+         * @param mode How to open the file.
+         */
+        explicit MappedVector(const std::string& path, MapMode mode = MapMode::OPEN_OR_CREATE) : data_(path, mode) {}
+
+        iterator begin() noexcept {
+            assert(!IsReadOnly());
+            return data_.GetAddress();
+        }
+
+        iterator end() noexcept {
+            assert(!IsReadOnly());
+            return data_.GetAddress() + Size();
+        }
+
+        const_iterator begin() const noexcept {
+            return data_.GetAddress();
+        }
+
+        const_iterator end() const noexcept {
+            return data_.GetAddress() + Size();
+        }
+
+        size_t Size() const noexcept {
+            return static_cast<size_t>(data_.StoredSize());
+        }
+
+        size_t Capacity() const noexcept {
+            return data_.Capacity();
+        }
+
+        bool IsReadOnly() const noexcept {
+            return data_.IsReadOnly();
+        }
+
+        const T& operator[](size_t index) const noexcept {
+            assert(index < Size());
+            return data_[index];
+        }
+
+        T& operator[](size_t index) noexcept {
+            assert(!IsReadOnly());
+            assert(index < Size());
+            return data_[index];
+        }
+
+        /**
+         * @brief Extends the file to hold new_capacity elements.
+         * @param new_capacity The new capacity to reserve.
+         */
+        void Reserve(size_t new_capacity) {
+            if (new_capacity > Capacity()) {
+                data_.Reallocate(new_capacity);
+            }
+        }
+
+        /**
+         * @brief Resizes the MappedVector, new elements are value-initialized.
+         * @param new_size The new size.
+         */
+        void Resize(size_t new_size) {
+            assert(!IsReadOnly());
+            const size_t size = Size();
+            if (new_size > size) {
+                Reserve(new_size);
+                std::uninitialized_value_construct_n(data_ + size, new_size - size);
+            }
+            data_.StoredSize() = new_size;
+        }
+
+        /**
+         * @brief Constructs a new element at the end of the MappedVector.
+         * @param args The arguments to forward.
+         * @return A reference to the new element.
+         */
+        template <typename... Args>
+        T& EmplaceBack(Args&&... args) {
+            assert(!IsReadOnly());
+            T value(std::forward<Args>(args)...);
+            const size_t size = Size();
+            if (size == Capacity()) {
+                data_.Reallocate(Growth::NextCapacity(Capacity(), size + 1, sizeof(T)));
+            }
+            T* item = new (data_ + size) T(value);
+            data_.StoredSize() = size + 1;
+            return *item;
+        }
+
+        void PushBack(const T& value) {
+            EmplaceBack(value);
+        }
+
+        void PopBack() noexcept {
+            assert(!IsReadOnly());
+            assert(Size() != 0);
+            --data_.StoredSize();
+        }
+
+        void Clear() noexcept {
+            assert(!IsReadOnly());
+            data_.StoredSize() = 0;
+        }
+
+        /**
+         * @brief Truncates the file to the size of the MappedVector.
+         */
+        void ShrinkToFit() {
+            if (Size() < Capacity()) {
+                data_.Reallocate(Size());
+            }
+        }
+
+        /**
+         * @brief Writes the modified pages to the file and waits for the writes to complete.
+         * Without it the changes reach the file when the kernel flushes the pages, even if the process crashes.
+         */
+        void Sync() {
+            data_.Sync();
+        }
+
+    private:
+        MappedMemory<T> data_;
+};
@@ -0,0 +1,394 @@
+// Performance contracts: upper bounds on the allocations and element operations of every operation.
+// The counts are deterministic, so a change that adds a reallocation, a copy or a move fails the test.
+#include "vector.h"
+#include "small_vector.h"
+#include "batch_appender.h"
+#include "segmented_vector.h"
+#include "flat_map.h"
+#include "cow_vector.h"
+#include "persistent_vector.h"
+#include "compact_vector.h"
+
+#include <cstdio>
+#include <iterator>
+#include <mutex>
+#include <optional>
+
+namespace {
+
+/**
+ * @brief The operations counted while a contract runs.
+ */
+struct Counts {
+    size_t allocations = 0;
+    size_t deallocations = 0;
+    size_t constructions = 0;       /*< Default and value constructions. */
+    size_t copies = 0;
+    size_t moves = 0;
+    size_t copy_assignments = 0;
+    size_t move_assignments = 0;
+    size_t destructions = 0;
+};
+
+Counts counts;
+
+/**
+ * @brief An element counting its special member functions.
+ */
+struct Counted {
+    Counted() noexcept {
+        ++counts.constructions;
+    }
+
+    explicit Counted(int id) noexcept : id(id) {
+        ++counts.constructions;
+    }
+
+    Counted(const Counted& other) noexcept : id(other.id) {
+        ++counts.copies;
+    }
+
+    Counted(Counted&& other) noexcept : id(other.id) {
+        ++counts.moves;
+    }
+
+    Counted& operator=(const Counted& other) noexcept {
+        id = other.id;
+        ++counts.copy_assignments;
+        return *this;
+    }
+
+    Counted& operator=(Counted&& other) noexcept {
+        id = other.id;
+        ++counts.move_assignments;
+        return *this;
+    }
+
+    ~Counted() {
+        ++counts.destructions;
+    }
+
+    friend bool operator==(const Counted& lhs, const Counted& rhs) noexcept {
+        return lhs.id == rhs.id;
+    }
+
+    friend auto operator<=>(const Counted& lhs, const Counted& rhs) noexcept {
+        return lhs.id <=> rhs.id;
+    }
+
+    int id = 0;
+};
+
+/**
+ * @brief A Counted element declared trivially relocatable, so Vector moves it with memcpy.
+ */
+struct Relocatable : Counted {
+    using Counted::Counted;
+};
+
+/**
+ * @brief A stateless allocator counting the blocks of every type it is rebound to.
+ */
+template <typename T>
+struct CountingAllocator {
+    using value_type = T;
+    using is_always_equal = std::true_type;
+
+    CountingAllocator() = default;
+
+    template <typename U>
+    CountingAllocator(const CountingAllocator<U>&) noexcept {}
+
+    T* allocate(size_t n) {
+        ++counts.allocations;
+        return std::allocator<T>{}.allocate(n);
+    }
+
+    void deallocate(T* p, size_t n) noexcept {
+        ++counts.deallocations;
+        std::allocator<T>{}.deallocate(p, n);
+    }
+
+    friend bool operator==(const CountingAllocator&, const CountingAllocator&) noexcept {
+        return true;
+    }
+};
+
+template <typename T>
+using CountingVector = Vector<T, CountingAllocator<T>>;
+
+int failures = 0;
+
+void CheckField(const char* contract, const char* field, size_t actual, size_t bound) {
+    if (actual > bound) {
+        std::fprintf(stderr, "%s: %zu %s, at most %zu allowed\n", contract, actual, field, bound);
+        ++failures;
+    }
+}
+
+/**
+ * @brief Runs an operation and checks its counts against the bounds, the fields left out allow none.
+ * @param contract The name of the contract.
+ * @param operation The operation to measure, the setup happens before and the teardown after it.
+ * @param bound The upper bounds.
+ */
+template <typename Operation>
+void Expect(const char* contract, Operation&& operation, const Counts& bound) {
+    counts = {};
+    operation();
+    const Counts actual = counts;
+    CheckField(contract, "allocations", actual.allocations, bound.allocations);
+    CheckField(contract, "deallocations", actual.deallocations, bound.deallocations);
+    CheckField(contract, "constructions", actual.constructions, bound.constructions);
+    CheckField(contract, "copies", actual.copies, bound.copies);
+    CheckField(contract, "moves", actual.moves, bound.moves);
+    CheckField(contract, "copy assignments", actual.copy_assignments, bound.copy_assignments);
+    CheckField(contract, "move assignments", actual.move_assignments, bound.move_assignments);
+    CheckField(contract, "destructions", actual.destructions, bound.destructions);
+}
+
+template <typename VectorType>
+VectorType MakeVector(size_t size, size_t capacity) {
+    VectorType v;
+    v.Reserve(capacity);
+    for (size_t i = 0; i < size; ++i) {
+        v.EmplaceBack(static_cast<int>(i));
+    }
+    return v;
+}
+
+constexpr size_t kSize = 100;
+
+}  // namespace
+
+template <>
+struct IsTriviallyRelocatable<Relocatable> : std::true_type {};
+
+namespace {
+
+void VectorContracts() {
+    using V = CountingVector<Counted>;
+
+    Expect("Vector()", [] { V v; }, {});
+    Expect("Vector(n)", [] { V v(kSize); }, {.allocations = 1, .deallocations = 1, .constructions = kSize, .destructions = kSize});
+    {
+        const V source = MakeVector<V>(kSize, kSize);
+        Expect("Vector(const Vector&)", [&] { V copy(source); }, {.allocations = 1, .deallocations = 1, .copies = kSize, .destructions = kSize});
+        Expect("Vector(first, last), forward", [&] { V copy(source.begin(), source.end()); },
+            {.allocations = 1, .deallocations = 1, .copies = kSize, .destructions = kSize});
+    }
+    {
+        V source = MakeVector<V>(kSize, kSize);
+        V* target = nullptr;
+        Expect("Vector(Vector&&)", [&] { target = new V(std::move(source)); }, {});
+        Expect("~Vector()", [&] { delete target; }, {.deallocations = 1, .destructions = kSize});
+    }
+    {
+        V target = MakeVector<V>(kSize, kSize);
+        V source = MakeVector<V>(kSize / 2, kSize / 2);
+        Expect("Vector::operator=(Vector&&)", [&] { target = std::move(source); }, {.deallocations = 1, .destructions = kSize});
+    }
+    {
+        V target = MakeVector<V>(kSize, kSize);
+        const V source = MakeVector<V>(kSize, kSize);
+        Expect("Vector::operator=(const Vector&), sufficient capacity", [&] { target = source; }, {.copy_assignments = kSize});
+    }
+    {
+        V v = MakeVector<V>(kSize, kSize);
+        Expect("Reserve, growing", [&] { v.Reserve(2 * kSize); }, {.allocations = 1, .deallocations = 1, .moves = kSize, .destructions = kSize});
+        Expect("Reserve, within capacity", [&] { v.Reserve(kSize); }, {});
+    }
+    {
+        V v = MakeVector<V>(kSize, kSize + 1);
+        const Counted value(-1);
+        Expect("PushBack(const T&), within capacity", [&] { v.PushBack(value); }, {.copies = 1});
+        Expect("PushBack(const T&), growing", [&] { v.PushBack(value); },
+            {.allocations = 1, .deallocations = 1, .copies = 1, .moves = kSize + 1, .destructions = kSize + 1});
+        Expect("EmplaceBack(args), within capacity", [&] { v.EmplaceBack(-2); }, {.constructions = 1});
+        Expect("PopBack", [&] { v.PopBack(); }, {.destructions = 1});
+    }
+    {
+        V v;
+        Expect("EmplaceBack x1000 from empty", [&] {
+            for (int i = 0; i < 1000; ++i) {
+                v.EmplaceBack(i);
+            }
+        }, {.allocations = 11, .deallocations = 10, .constructions = 1000, .moves = 1023, .destructions = 1023});
+    }
+    {
+        V v = MakeVector<V>(kSize, kSize + 1);
+        const Counted value(-1);
+        Expect("Insert(pos, const T&), within capacity", [&] { v.Insert(v.begin() + 10, value); },
+            {.copies = 1, .moves = 1, .move_assignments = kSize - 10, .destructions = 1});
+    }
+    {
+        V v = MakeVector<V>(kSize, kSize);
+        const Counted value(-1);
+        Expect("Insert(pos, const T&), growing", [&] { v.Insert(v.begin() + 10, value); },
+            {.allocations = 1, .deallocations = 1, .copies = 1, .moves = kSize, .destructions = kSize});
+    }
+    {
+        V v = MakeVector<V>(kSize, kSize);
+        const V more = MakeVector<V>(10, 10);
+        Expect("Insert(pos, first, last), growing", [&] { v.Insert(v.begin() + 50, more.begin(), more.end()); },
+            {.allocations = 1, .deallocations = 1, .copies = 10, .moves = kSize, .destructions = kSize});
+        Expect("Insert(pos, first, last), within capacity", [&] { v.Insert(v.begin() + 50, more.begin(), more.end()); },
+            {.moves = 10, .copy_assignments = 10, .move_assignments = kSize + 10 - 50 - 10});
+        Expect("Append(first, last), within capacity", [&] { v.Append(more.begin(), more.end()); }, {.copies = 10});
+    }
+    {
+        V v = MakeVector<V>(kSize, kSize);
+        Expect("Erase(first, last)", [&] { v.Erase(v.begin() + 10, v.begin() + 20); },
+            {.move_assignments = kSize - 20, .destructions = 10});
+        Expect("Erase(pos), last element", [&] { v.Erase(v.end() - 1); }, {.destructions = 1});
+        Expect("Resize, shrinking", [&] { v.Resize(10); }, {.destructions = kSize - 21});
+        Expect("Resize, growing within capacity", [&] { v.Resize(20); }, {.constructions = 10});
+        Expect("ShrinkToFit", [&] { v.ShrinkToFit(); }, {.allocations = 1, .deallocations = 1, .moves = 20, .destructions = 20});
+        Expect("Clear", [&] { v.Clear(); }, {.destructions = 20});
+    }
+    {
+        V a = MakeVector<V>(kSize, kSize);
+        V b = MakeVector<V>(10, 10);
+        Expect("Swap", [&] { a.Swap(b); }, {});
+    }
+    {
+        V v;
+        for (int i = 0; i < 2 * static_cast<int>(kSize); i += 2) {
+            v.EmplaceBack(i);
+        }
+        v.Reserve(2 * kSize);
+        V odd;
+        for (int i = 1; i < 2 * static_cast<int>(kSize); i += 2) {
+            odd.EmplaceBack(i);
+        }
+        Expect("MergeInsert, within capacity", [&] { v.MergeInsert(odd.begin(), odd.end()); },
+            {.copies = kSize / 2, .moves = kSize / 2, .copy_assignments = kSize / 2, .move_assignments = kSize / 2 - 1});
+        Expect("InsertSorted, at the end", [&] { v.InsertSorted(Counted(1000)); },
+            {.allocations = 1, .deallocations = 1, .constructions = 1, .moves = 2 * kSize + 1, .destructions = 2 * kSize + 1});
+    }
+    {
+        V v = MakeVector<V>(kSize, kSize);
+        V other;
+        Expect("Release and Adopt", [&] {
+            ReleasedBuffer<Counted> released = v.Release();
+            other.Adopt(released.data, released.size, released.capacity);
+        }, {});
+    }
+}
+
+void RelocationContracts() {
+    using V = CountingVector<Relocatable>;
+    {
+        V v = MakeVector<V>(kSize, kSize);
+        Expect("Reserve, bitwise relocation", [&] { v.Reserve(2 * kSize); }, {.allocations = 1, .deallocations = 1});
+        Expect("Erase, bitwise relocation", [&] { v.Erase(v.begin()); }, {.destructions = 1});
+        const Relocatable value(-1);
+        Expect("Insert, bitwise relocation, within capacity", [&] { v.Insert(v.begin(), value); },
+            {.copies = 1, .moves = 1, .move_assignments = kSize - 1, .destructions = 1});
+    }
+    {
+        V v;
+        Expect("EmplaceBack x1000 from empty, bitwise relocation", [&] {
+            for (int i = 0; i < 1000; ++i) {
+                v.EmplaceBack(i);
+            }
+        }, {.allocations = 11, .deallocations = 10, .constructions = 1000});
+    }
+}
+
+void SmallVectorContracts() {
+    using S = SmallVector<Counted, 8, CountingAllocator<Counted>>;
+    {
+        S v;
+        Expect("SmallVector, filling the inline buffer", [&] {
+            for (int i = 0; i < 8; ++i) {
+                v.EmplaceBack(i);
+            }
+        }, {.constructions = 8});
+        Expect("SmallVector, spilling to the heap", [&] { v.EmplaceBack(8); },
+            {.allocations = 1, .constructions = 1, .moves = 8, .destructions = 8});
+        std::optional<S> other;
+        Expect("SmallVector(SmallVector&&), heap", [&] { other.emplace(std::move(v)); }, {});
+    }
+    {
+        S v = MakeVector<S>(4, 4);
+        std::optional<S> other;
+        Expect("SmallVector(SmallVector&&), inline", [&] { other.emplace(std::move(v)); },
+            {.moves = 4, .destructions = 4});
+        Expect("SmallVector::ShrinkToFit, inline", [&] { v.ShrinkToFit(); }, {});
+    }
+}
+
+void ContainerContracts() {
+    {
+        CountingVector<Counted> target = MakeVector<CountingVector<Counted>>(kSize, kSize);
+        std::mutex mutex;
+        BatchAppender appender(target, mutex, 16);
+        for (int i = 0; i < 10; ++i) {
+            appender.EmplaceBack(i);
+        }
+        Expect("BatchAppender::Flush", [&] { appender.Flush(); },
+            {.allocations = 1, .deallocations = 1, .moves = kSize + 10, .destructions = kSize + 10});
+    }
+    {
+        // Six segments of 16 to 512 elements, and the segment table reserved one slot per segment.
+        SegmentedVector<Counted, CountingAllocator<Counted>> v;
+        Expect("SegmentedVector, EmplaceBack x1000", [&] {
+            for (int i = 0; i < 1000; ++i) {
+                v.EmplaceBack(i);
+            }
+        }, {.allocations = 6 + 6, .deallocations = 5, .constructions = 1000});
+    }
+    {
+        using C = CompactVector<Counted, CountingAllocator<Counted>>;
+        C v = MakeVector<C>(kSize, kSize);
+        Expect("CompactVector::PushBack, growing", [&] { v.EmplaceBack(-1); },
+            {.allocations = 1, .deallocations = 1, .constructions = 1, .moves = kSize, .destructions = kSize});
+    }
+    {
+        CowVector<Counted, CountingAllocator<Counted>> table(MakeVector<CountingVector<Counted>>(kSize, kSize));
+        CowVector<Counted, CountingAllocator<Counted>> snapshot;
+        Expect("CowVector copy", [&] { snapshot = table; }, {});
+        Expect("CowVector, first mutation of a shared copy", [&] { snapshot.Mutate(); },
+            {.allocations = 2, .copies = kSize});
+        Expect("CowVector, mutation of a unique copy", [&] { snapshot.Mutate(); }, {});
+    }
+    {
+        PersistentVector<Counted, CountingAllocator<Counted>> base;
+        for (int i = 0; i < 1000; ++i) {
+            base.EmplaceBack(i);
+        }
+        PersistentVector<Counted, CountingAllocator<Counted>> next;
+        const Counted value(-1);
+        Expect("PersistentVector snapshot", [&] { next = base; }, {});
+        Expect("PersistentVector::Set on a shared path", [&] { next.Set(5, value); },
+            {.allocations = 2, .copies = 32, .copy_assignments = 1});
+        Expect("PersistentVector::Set on a private path", [&] { next.Set(6, value); }, {.copy_assignments = 1});
+        Expect("PersistentVector::PushBack into a shared tail", [&] { next.PushBack(value); },
+            {.allocations = 1, .copies = 1000 % 32 + 1});
+        Expect("PersistentVector::PushBack into a private tail", [&] { next.PushBack(value); }, {.copies = 1});
+    }
+    {
+        FlatSet<int, std::less<int>, CountingAllocator<int>> set;
+        for (int i = 0; i < 200; i += 2) {
+            set.Insert(i);
+        }
+        set.Reserve(200);
+        const int more[] = {7, 3, 5, 1, 9, 4};
+        Expect("FlatSet bulk Insert, within capacity", [&] { set.Insert(std::begin(more), std::end(more)); },
+            {.allocations = 1, .deallocations = 1});
+    }
+}
+
+}  // namespace
+
+int main() {
+    VectorContracts();
+    RelocationContracts();
+    SmallVectorContracts();
+    ContainerContracts();
+    if (failures != 0) {
+        std::fprintf(stderr, "%d performance contract violations\n", failures);
+        return 1;
+    }
+}
@@ -0,0 +1,530 @@
+#pragma once
+
+/**
+ * @file persistent_vector.h
+ * @brief Definition of the PersistentVector class, a vector whose copies share structure.
+ */
+
+#include "vector.h"
+
+#include <atomic>
+#include <initializer_list>
+#include <iterator>
+
+/**
+ * @brief The PersistentVector class is a 32-way trie of fixed-size leaves plus a separate tail leaf,
+ * so a copy is an O(1) snapshot that shares every node with the original.
+ * Mutations copy only the nodes on the path to the changed element that are still shared with another copy:
+ * Set is O(log32 n) and EmplaceBack is amortized O(1), since it fills the tail in place and pushes
+ * it into the trie once every 32 elements.
+ *
+ * A node owned by a single PersistentVector is mutated in place, which makes the object its own transient:
+ * a batch of mutations right after a snapshot copies each shared path once, and the following mutations
+ * on the same nodes allocate nothing.
+ * As with std::shared_ptr, different PersistentVector objects sharing nodes may be used from different threads.
+ * The mutating members invalidate the references and iterators obtained before.
+ */
+template <typename T, typename Alloc = std::allocator<T>>
+class PersistentVector {
+    using AllocTraits = std::allocator_traits<Alloc>;
+
+    static constexpr size_t kBits = 5;                      /*< The number of index bits consumed per trie level. */
+    static constexpr size_t kBranching = size_t(1) << kBits;   /*< The number of children of a node and elements of a leaf. */
+    static constexpr size_t kMask = kBranching - 1;
+
+    class ConstIterator;
+
+    public:
+        using value_type = T;
+        using allocator_type = Alloc;
+        using const_iterator = ConstIterator;
+
+        PersistentVector() = default;
+
+        /**
+         * @brief Constructs an empty PersistentVector using the allocator.
+         * @param alloc The allocator.
+         */
+        explicit PersistentVector(const Alloc& alloc) noexcept : alloc_(alloc) {}
+
+        template <std::input_iterator InputIt>
+        PersistentVector(InputIt first, InputIt last, const Alloc& alloc = Alloc()) : PersistentVector(alloc) {
+            for (; first != last; ++first) {
+                EmplaceBack(*first);
+            }
+        }
+
+        PersistentVector(std::initializer_list<T> init, const Alloc& alloc = Alloc()) : PersistentVector(init.begin(), init.end(), alloc) {}
+
+        /**
+         * @brief Copy constructor. Takes an O(1) snapshot sharing all nodes of the other PersistentVector.
+         * @param other The PersistentVector to share the nodes of.
+         */
+        PersistentVector(const PersistentVector& other) noexcept
+            : alloc_(other.alloc_), root_(other.root_), tail_(other.tail_), size_(other.size_), shift_(other.shift_) {
+            AddRef(root_);
+            AddRef(tail_);
+        }
+
+        PersistentVector(PersistentVector&& other) noexcept
+            : alloc_(other.alloc_), root_(std::exchange(other.root_, nullptr)), tail_(std::exchange(other.tail_, nullptr))
+            , size_(std::exchange(other.size_, 0)), shift_(std::exchange(other.shift_, kBits)) {}
+
+        ~PersistentVector() {
+            Clear();
+        }
+
+        PersistentVector& operator=(const PersistentVector& rhs) noexcept {
+            if (this != &rhs) {
+                PersistentVector copy(rhs);
+                Swap(copy);
+            }
+            return *this;
+        }
+
+        PersistentVector& operator=(PersistentVector&& rhs) noexcept {
+            if (this != &rhs) {
+                Clear();
+                Swap(rhs);
+            }
+            return *this;
+        }
+
+        const_iterator begin() const noexcept {
+            return {this, 0};
+        }
+
+        const_iterator end() const noexcept {
+            return {this, size_};
+        }
+
+        size_t Size() const noexcept {
+            return size_;
+        }
+
+        allocator_type GetAllocator() const noexcept {
+            return alloc_;
+        }
+
+        const T& operator[](size_t index) const noexcept {
+            assert(index < size_);
+            return LeafFor(index)->Data()[index & kMask];
+        }
+
+        /**
+         * @brief Constructs a new element at the end, pushing the full tail into the trie first if needed.
+         * The elements are left unchanged if an exception is thrown.
+         * @param args The arguments to forward to the constructor.
+         * @return A reference to the new element.
+         */
+        template <typename... Args>
+        const T& EmplaceBack(Args&&... args) {
+            if (tail_ != nullptr && tail_->size < kBranching) {
+                tail_ = UniqueLeaf(tail_);
+                T* slot = tail_->Data() + tail_->size;
+                detail::ConstructAt(alloc_, slot, std::forward<Args>(args)...);
+                ++tail_->size;
+                ++size_;
+                return *slot;
+            }
+
+            Leaf* leaf = NewLeaf();
+            try {
+                detail::ConstructAt(alloc_, leaf->Data(), std::forward<Args>(args)...);
+                leaf->size = 1;
+                if (tail_ != nullptr) {
+                    PushTail();
+                }
+            }
+            catch (...) {
+                DestroyLeaf(leaf);
+                throw;
+            }
+            tail_ = leaf;
+            ++size_;
+            return *leaf->Data();
+        }
+
+        template <typename Type>
+        void PushBack(Type&& value) {
+            EmplaceBack(std::forward<Type>(value));
+        }
+
+        /**
+         * @brief Assigns a new value to an element, copying the shared nodes on its path first.
+         * @param index The index of the element.
+         * @param value The value to assign.
+         */
+        template <typename Type>
+        void Set(size_t index, Type&& value) {
+            assert(index < size_);
+            *MutableSlot(index) = std::forward<Type>(value);
+        }
+
+        /**
+         * @brief Removes the last element. Once the tail is empty, the last leaf of the trie becomes the tail.
+         */
+        void PopBack() {
+            assert(size_ != 0);
+            if (tail_->size > 1) {
+                tail_ = UniqueLeaf(tail_);
+                detail::DestroyAt(alloc_, tail_->Data() + --tail_->size);
+                --size_;
+                return;
+            }
+
+            Leaf* old_tail = tail_;
+            if (size_ == 1) {
+                tail_ = nullptr;
+                size_ = 0;
+                Release(old_tail, 0);
+                return;
+            }
+
+            Leaf* new_tail = LeafFor(size_ - 2);
+            AddRef(new_tail);
+            bool trie_empty;
+            try {
+                root_ = UniqueInner(root_, shift_);
+                trie_empty = PopTail(root_, shift_);
+            }
+            catch (...) {
+                Release(new_tail, 0);
+                throw;
+            }
+            if (trie_empty) {
+                Release(root_, shift_);
+                root_ = nullptr;
+                shift_ = kBits;
+            }
+            else if (shift_ > kBits && root_->children[1] == nullptr) {
+                Inner* old_root = root_;
+                root_ = static_cast<Inner*>(old_root->children[0]);
+                AddRef(root_);
+                Release(old_root, shift_);
+                shift_ -= kBits;
+            }
+            tail_ = new_tail;
+            --size_;
+            Release(old_tail, 0);
+        }
+
+        /**
+         * @brief Drops the references to all nodes, the nodes shared with other copies stay alive.
+         */
+        void Clear() noexcept {
+            Release(std::exchange(root_, nullptr), shift_);
+            Release(std::exchange(tail_, nullptr), 0);
+            size_ = 0;
+            shift_ = kBits;
+        }
+
+        void Swap(PersistentVector& other) noexcept {
+            std::swap(alloc_, other.alloc_);
+            std::swap(root_, other.root_);
+            std::swap(tail_, other.tail_);
+            std::swap(size_, other.size_);
+            std::swap(shift_, other.shift_);
+        }
+
+        /**
+         * @brief Calls f(first, count) for every leaf in index order, all leaves but the tail hold 32 elements.
+         * @param f The callback.
+         */
+        template <typename F>
+        void ForEachChunk(F f) const {
+            for (size_t index = 0; index < size_; index += kBranching) {
+                const Leaf* leaf = LeafFor(index);
+                f(static_cast<const T*>(leaf->Data()), leaf->size);
+            }
+        }
+
+        friend bool operator==(const PersistentVector& lhs, const PersistentVector& rhs) {
+            if (lhs.root_ == rhs.root_ && lhs.tail_ == rhs.tail_) {
+                return true;
+            }
+            return lhs.size_ == rhs.size_ && std::equal(lhs.begin(), lhs.end(), rhs.begin());
+        }
+
+    private:
+        struct Node {
+            std::atomic<size_t> refs = 1;   /*< The number of parents and PersistentVector objects referring to the node. */
+        };
+
+        struct Inner : Node {
+            Node* children[kBranching] = {};    /*< The children, Inner nodes above the last level and Leaf nodes on it. */
+        };
+
+        struct Leaf : Node {
+            size_t size = 0;                                    /*< The number of constructed elements. */
+            alignas(T) unsigned char storage[kBranching * sizeof(T)];  /*< The storage of the elements. */
+
+            T* Data() noexcept {
+                return reinterpret_cast<T*>(storage);
+            }
+
+            const T* Data() const noexcept {
+                return reinterpret_cast<const T*>(storage);
+            }
+        };
+
+        using InnerAlloc = typename AllocTraits::template rebind_alloc<Inner>;
+        using LeafAlloc = typename AllocTraits::template rebind_alloc<Leaf>;
+
+        [[no_unique_address]] Alloc alloc_;     /*< The allocator of the elements and the nodes. */
+        Inner* root_ = nullptr;                 /*< The root of the trie, nullptr while all elements fit in the tail. */
+        Leaf* tail_ = nullptr;                  /*< The last leaf, kept out of the trie so EmplaceBack fills it in place. */
+        size_t size_ = 0;                       /*< The number of elements. */
+        size_t shift_ = kBits;                  /*< The index shift of the root level, a multiple of kBits. */
+
+        /**
+         * @brief Gets the index of the first element in the tail.
+         */
+        size_t TailOffset() const noexcept {
+            return size_ < kBranching ? 0 : ((size_ - 1) >> kBits) << kBits;
+        }
+
+        Leaf* LeafFor(size_t index) const noexcept {
+            if (index >= TailOffset()) {
+                return tail_;
+            }
+            Node* node = root_;
+            for (size_t level = shift_; level > 0; level -= kBits) {
+                node = static_cast<Inner*>(node)->children[(index >> level) & kMask];
+            }
+            return static_cast<Leaf*>(node);
+        }
+
+        /**
+         * @brief Gets the slot of an element for writing, replacing the shared nodes on its path by private copies.
+         * The elements are left unchanged if a copy throws.
+         */
+        T* MutableSlot(size_t index) {
+            if (index >= TailOffset()) {
+                tail_ = UniqueLeaf(tail_);
+                return tail_->Data() + (index & kMask);
+            }
+
+            root_ = UniqueInner(root_, shift_);
+            Inner* node = root_;
+            for (size_t level = shift_; level > kBits; level -= kBits) {
+                Node*& child = node->children[(index >> level) & kMask];
+                child = UniqueInner(static_cast<Inner*>(child), level - kBits);
+                node = static_cast<Inner*>(child);
+            }
+            Node*& leaf = node->children[(index >> kBits) & kMask];
+            leaf = UniqueLeaf(static_cast<Leaf*>(leaf));
+            return static_cast<Leaf*>(leaf)->Data() + (index & kMask);
+        }
+
+        /**
+         * @brief Moves the full tail into the trie, adding a root level once the trie is full.
+         * The trie keeps its content if an allocation throws.
+         */
+        void PushTail() {
+            if (root_ == nullptr) {
+                root_ = NewInner();
+                root_->children[0] = tail_;
+                return;
+            }
+            if ((size_ >> kBits) > (size_t(1) << shift_)) {
+                Inner* new_root = NewInner();
+                try {
+                    new_root->children[1] = NewPath(shift_, tail_);
+                }
+                catch (...) {
+                    FreeInner(new_root);
+                    throw;
+                }
+                new_root->children[0] = root_;
+                root_ = new_root;
+                shift_ += kBits;
+                return;
+            }
+
+            root_ = UniqueInner(root_, shift_);
+            Inner* node = root_;
+            for (size_t level = shift_; level > kBits; level -= kBits) {
+                Node*& child = node->children[((size_ - 1) >> level) & kMask];
+                if (child == nullptr) {
+                    child = NewPath(level - kBits, tail_);
+                    return;
+                }
+                child = UniqueInner(static_cast<Inner*>(child), level - kBits);
+                node = static_cast<Inner*>(child);
+            }
+            node->children[((size_ - 1) >> kBits) & kMask] = tail_;
+        }
+
+        /**
+         * @brief Removes the last leaf of the trie below a private node, making the nodes on the path private.
+         * @return Whether the node has no children left.
+         */
+        bool PopTail(Inner* node, size_t level) {
+            const size_t index = ((size_ - 2) >> level) & kMask;
+            Node*& child = node->children[index];
+            if (level > kBits) {
+                child = UniqueInner(static_cast<Inner*>(child), level - kBits);
+                if (!PopTail(static_cast<Inner*>(child), level - kBits)) {
+                    return false;
+                }
+            }
+            Release(std::exchange(child, nullptr), level - kBits);
+            return index == 0;
+        }
+
+        /**
+         * @brief Builds a chain of Inner nodes from the level down to the leaf.
+         * @return The node on the level, the leaf itself for level 0.
+         */
+        Node* NewPath(size_t level, Leaf* leaf) {
+            Node* node = leaf;
+            try {
+                for (size_t depth = kBits; depth <= level; depth += kBits) {
+                    Inner* inner = NewInner();
+                    inner->children[0] = node;
+                    node = inner;
+                }
+            }
+            catch (...) {
+                while (node != leaf) {
+                    Inner* inner = static_cast<Inner*>(node);
+                    node = inner->children[0];
+                    FreeInner(inner);
+                }
+                throw;
+            }
+            return node;
+        }
+
+        /**
+         * @brief Gets a node owned by this PersistentVector alone, replacing a shared node by a copy.
+         * @param node The node, whose reference is given up if it is copied.
+         * @param level The level of the node.
+         */
+        Inner* UniqueInner(Inner* node, size_t level) {
+            if (node->refs.load(std::memory_order_acquire) == 1) {
+                return node;
+            }
+            Inner* copy = NewInner();
+            for (size_t i = 0; i < kBranching; ++i) {
+                AddRef(copy->children[i] = node->children[i]);
+            }
+            Release(node, level);
+            return copy;
+        }
+
+        Leaf* UniqueLeaf(Leaf* leaf) {
+            if (leaf->refs.load(std::memory_order_acquire) == 1) {
+                return leaf;
+            }
+            Leaf* copy = NewLeaf();
+            try {
+                detail::UninitializedCopyN(alloc_, leaf->Data(), leaf->size, copy->Data());
+            }
+            catch (...) {
+                DestroyLeaf(copy);
+                throw;
+            }
+            copy->size = leaf->size;
+            Release(leaf, 0);
+            return copy;
+        }
+
+        static void AddRef(Node* node) noexcept {
+            if (node != nullptr) {
+                node->refs.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+
+        /**
+         * @brief Drops a reference to a node, destroying it and releasing its children if it was the last one.
+         * @param node The node, may be nullptr.
+         * @param level The level of the node, 0 for a leaf.
+         */
+        void Release(Node* node, size_t level) noexcept {
+            if (node == nullptr || node->refs.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+                return;
+            }
+            if (level == 0) {
+                DestroyLeaf(static_cast<Leaf*>(node));
+                return;
+            }
+            Inner* inner = static_cast<Inner*>(node);
+            for (Node* child : inner->children) {
+                Release(child, level - kBits);
+            }
+            FreeInner(inner);
+        }
+
+        Inner* NewInner() {
+            InnerAlloc alloc(alloc_);
+            return ::new (static_cast<void*>(std::allocator_traits<InnerAlloc>::allocate(alloc, 1))) Inner;
+        }
+
+        void FreeInner(Inner* inner) noexcept {
+            InnerAlloc alloc(alloc_);
+            inner->~Inner();
+            std::allocator_traits<InnerAlloc>::deallocate(alloc, inner, 1);
+        }
+
+        Leaf* NewLeaf() {
+            LeafAlloc alloc(alloc_);
+            return ::new (static_cast<void*>(std::allocator_traits<LeafAlloc>::allocate(alloc, 1))) Leaf;
+        }
+
+        void DestroyLeaf(Leaf* leaf) noexcept {
+            detail::DestroyN(alloc_, leaf->Data(), leaf->size);
+            LeafAlloc alloc(alloc_);
+            leaf->~Leaf();
+            std::allocator_traits<LeafAlloc>::deallocate(alloc, leaf, 1);
+        }
+
+        /**
+         * @brief Forward iterator over the elements, caching the leaf of the current element.
+         */
+        class ConstIterator {
+            public:
+                using iterator_category = std::forward_iterator_tag;
+                using value_type = T;
+                using difference_type = std::ptrdiff_t;
+                using pointer = const T*;
+                using reference = const T&;
+
+                ConstIterator() = default;
+
+                ConstIterator(const PersistentVector* owner, size_t index) noexcept
+                    : owner_(owner), index_(index), chunk_(index < owner->size_ ? owner->LeafFor(index)->Data() : nullptr) {}
+
+                reference operator*() const noexcept {
+                    return chunk_[index_ & kMask];
+                }
+
+                pointer operator->() const noexcept {
+                    return &**this;
+                }
+
+                ConstIterator& operator++() noexcept {
+                    ++index_;
+                    if ((index_ & kMask) == 0 && index_ < owner_->size_) {
+                        chunk_ = owner_->LeafFor(index_)->Data();
+                    }
+                    return *this;
+                }
+
+                ConstIterator operator++(int) noexcept {
+                    ConstIterator copy = *this;
+                    ++*this;
+                    return copy;
+                }
+
+                friend bool operator==(const ConstIterator& lhs, const ConstIterator& rhs) noexcept {
+                    return lhs.index_ == rhs.index_;
+                }
+
+            private:
+                const PersistentVector* owner_ = nullptr;   /*< The iterated PersistentVector. */
+                size_t index_ = 0;                          /*< The index of the current element. */
+                const T* chunk_ = nullptr;                  /*< The elements of the leaf holding the current element. */
+        };
+};
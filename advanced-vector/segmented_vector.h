@@ -0,0 +1,443 @@
+#pragma once
+
+/**
+ * @file segmented_vector.h
+ * @brief Definition of the SegmentedVector class, a vector whose elements never move when it grows.
+ */
+
+#include "vector.h"
+
+#include <bit>
+#include <compare>
+#include <limits>
+
+namespace detail {
+
+/**
+ * @brief Maps element indices to segments of geometrically growing size.
+ * The segment k holds FirstSegment << k elements and starts at the index FirstSegment * (2^k - 1),
+ * so the segment of an index is found with a single bit_width.
+ */
+template <size_t FirstSegment>
+struct SegmentLayout {
+    static_assert(FirstSegment > 0 && (FirstSegment & (FirstSegment - 1)) == 0, "FirstSegment must be a power of two");
+
+    static constexpr size_t kFirstSegmentShift = std::bit_width(FirstSegment) - 1;
+    static constexpr size_t kMaxSegments = std::numeric_limits<size_t>::digits - kFirstSegmentShift;
+
+    static constexpr size_t SegmentOf(size_t index) noexcept {
+        return std::bit_width((index >> kFirstSegmentShift) + 1) - 1;
+    }
+
+    static constexpr size_t SegmentStart(size_t k) noexcept {
+        return FirstSegment * ((size_t(1) << k) - 1);
+    }
+
+    static constexpr size_t SegmentSize(size_t k) noexcept {
+        return FirstSegment << k;
+    }
+};
+
+}  // namespace detail
+
+/**
+ * @brief The SegmentedVector class is a vector that stores its elements in segments of growing size
+ * and never relocates them, so pointers and references to the elements stay valid while it grows.
+ * Indexing is O(1) and growing only allocates a new segment, which doubles the capacity.
+ * Emplace and Erase in the middle shift the following elements by assignment, as Vector does.
+ * @tparam FirstSegment The number of elements in the first segment, a power of two.
+ */
+template <typename T, typename Alloc = std::allocator<T>, size_t FirstSegment = 16>
+class SegmentedVector {
+    using AllocTraits = std::allocator_traits<Alloc>;
+    using Layout = detail::SegmentLayout<FirstSegment>;
+    using SegmentAlloc = typename AllocTraits::template rebind_alloc<T*>;
+
+    template <typename Value>
+    class Iterator;
+
+    public:
+        using iterator = Iterator<T>;
+        using const_iterator = Iterator<const T>;
+        using allocator_type = Alloc;
+
+        SegmentedVector() = default;
+
+        /**
+         * @brief Constructs an empty SegmentedVector using the allocator.
+         * @param alloc The allocator.
+         */
+        explicit SegmentedVector(const Alloc& alloc) noexcept : alloc_(alloc), segments_(SegmentAlloc(alloc)) {}
+
+        /**
+         * @brief Constructs a SegmentedVector of value-initialized elements.
+         * @param size The initial size.
+         * @param alloc The allocator.
+         */
+        explicit SegmentedVector(size_t size, const Alloc& alloc = Alloc()) : SegmentedVector(alloc) {
+            Resize(size);
+        }
+
+        /**
+         * @brief Copy constructor.
+         * The allocator is obtained by select_on_container_copy_construction.
+         * @param other The other SegmentedVector object to copy from.
+         */
+        SegmentedVector(const SegmentedVector& other)
+            : SegmentedVector(AllocTraits::select_on_container_copy_construction(other.alloc_)) {
+            Reserve(other.size_);
+            for (const T& value : other) {
+                EmplaceBack(value);
+            }
+        }
+
+        SegmentedVector(SegmentedVector&& other) noexcept
+            : alloc_(std::move(other.alloc_)), segments_(std::move(other.segments_)), size_(std::exchange(other.size_, 0)) {}
+
+        /**
+         * @brief Copy assignment operator, gives the strong guarantee.
+         * @param rhs The other SegmentedVector object to copy from.
+         * @return A reference to the current SegmentedVector object.
+         */
+        SegmentedVector& operator=(const SegmentedVector& rhs) {
+            if (this != &rhs) {
+                SegmentedVector copy(rhs);
+                Swap(copy);
+            }
+            return *this;
+        }
+
+        /**
+         * @brief Move assignment operator.
+         * The allocator is transferred only if it propagates on move assignment, otherwise both allocators must compare equal.
+         * @param rhs The other SegmentedVector object to move from.
+         * @return A reference to the current SegmentedVector object.
+         */
+        SegmentedVector& operator=(SegmentedVector&& rhs) noexcept {
+            if (this != &rhs) {
+                Clear();
+                FreeSegments(0);
+                if constexpr (AllocTraits::propagate_on_container_move_assignment::value) {
+                    alloc_ = std::move(rhs.alloc_);
+                }
+                else {
+                    assert(alloc_ == rhs.alloc_);
+                }
+                segments_ = std::move(rhs.segments_);
+                size_ = std::exchange(rhs.size_, 0);
+            }
+            return *this;
+        }
+
+        ~SegmentedVector() {
+            Clear();
+            FreeSegments(0);
+        }
+
+        iterator begin() noexcept {
+            return {this, 0};
+        }
+
+        iterator end() noexcept {
+            return {this, size_};
+        }
+
+        const_iterator begin() const noexcept {
+            return {const_cast<SegmentedVector*>(this), 0};
+        }
+
+        const_iterator end() const noexcept {
+            return {const_cast<SegmentedVector*>(this), size_};
+        }
+
+        const_iterator cbegin() const noexcept {
+            return begin();
+        }
+
+        const_iterator cend() const noexcept {
+            return end();
+        }
+
+        size_t Size() const noexcept {
+            return size_;
+        }
+
+        /**
+         * @brief Gets the number of elements the allocated segments have room for.
+         * @return The capacity.
+         */
+        size_t Capacity() const noexcept {
+            return Layout::SegmentStart(segments_.Size());
+        }
+
+        allocator_type GetAllocator() const noexcept {
+            return alloc_;
+        }
+
+        const T& operator[](size_t index) const noexcept {
+            return const_cast<SegmentedVector&>(*this)[index];
+        }
+
+        T& operator[](size_t index) noexcept {
+            assert(index < size_);
+            return *Slot(index);
+        }
+
+        /**
+         * @brief Allocates segments until the capacity reaches new_capacity, no element is moved.
+         * @param new_capacity The new capacity to reserve.
+         */
+        void Reserve(size_t new_capacity) {
+            while (Capacity() < new_capacity) {
+                AddSegment();
+            }
+        }
+
+        /**
+         * @brief Resizes the SegmentedVector, new elements are value-initialized.
+         * @param new_size The new size.
+         */
+        void Resize(size_t new_size) {
+            Reserve(new_size);
+            while (size_ < new_size) {
+                EmplaceBack();
+            }
+            while (size_ > new_size) {
+                PopBack();
+            }
+        }
+
+        /**
+         * @brief Emplaces a new element at the end, allocating a new segment if the last one is full.
+         * @param args The arguments to forward to the constructor.
+         * @return A reference to the new element.
+         */
+        template <typename... Args>
+        T& EmplaceBack(Args&&... args) {
+            if (size_ == Capacity()) {
+                AddSegment();
+            }
+            T* slot = Slot(size_);
+            detail::ConstructAt(alloc_, slot, std::forward<Args>(args)...);
+            ++size_;
+            return *slot;
+        }
+
+        template <typename Type>
+        void PushBack(Type&& value) {
+            EmplaceBack(std::forward<Type>(value));
+        }
+
+        /**
+         * @brief Emplaces a new element at the specified position, the following elements are shifted by assignment.
+         * @param pos The position at which to emplace the element.
+         * @param args The arguments to forward to the constructor.
+         * @return An iterator pointing to the new element.
+         */
+        template <typename... Args>
+        iterator Emplace(const_iterator pos, Args&&... args) {
+            const size_t index = pos.index_;
+            assert(index <= size_);
+            if (index == size_) {
+                EmplaceBack(std::forward<Args>(args)...);
+                return {this, index};
+            }
+
+            T value(std::forward<Args>(args)...);
+            EmplaceBack(std::move((*this)[size_ - 1]));
+            for (size_t i = size_ - 2; i > index; --i) {
+                (*this)[i] = std::move((*this)[i - 1]);
+            }
+            (*this)[index] = std::move(value);
+            return {this, index};
+        }
+
+        template <typename Type>
+        iterator Insert(const_iterator pos, Type&& value) {
+            return Emplace(pos, std::forward<Type>(value));
+        }
+
+        /**
+         * @brief Erases the element at the specified position, the following elements are shifted by assignment.
+         * @param pos The position of the element to erase.
+         * @return An iterator pointing to the element following the erased one.
+         */
+        iterator Erase(const_iterator pos) {
+            const size_t index = pos.index_;
+            assert(index < size_);
+            for (size_t i = index; i + 1 < size_; ++i) {
+                (*this)[i] = std::move((*this)[i + 1]);
+            }
+            PopBack();
+            return {this, index};
+        }
+
+        void PopBack() noexcept {
+            assert(size_ != 0);
+            --size_;
+            detail::DestroyAt(alloc_, Slot(size_));
+        }
+
+        /**
+         * @brief Destroys all elements and keeps the segments.
+         */
+        void Clear() noexcept {
+            for (size_t k = 0; k < segments_.Size() && Layout::SegmentStart(k) < size_; ++k) {
+                detail::DestroyN(alloc_, segments_[k], std::min(Layout::SegmentSize(k), size_ - Layout::SegmentStart(k)));
+            }
+            size_ = 0;
+        }
+
+        /**
+         * @brief Releases the segments past the one holding the last element.
+         */
+        void ShrinkToFit() noexcept {
+            FreeSegments(size_ == 0 ? 0 : Layout::SegmentOf(size_ - 1) + 1);
+        }
+
+        /**
+         * @brief Swaps the content of two SegmentedVector objects.
+         * The allocators are swapped only if they propagate on swap, otherwise they must compare equal.
+         * @param other The other SegmentedVector object.
+         */
+        void Swap(SegmentedVector& other) noexcept {
+            if constexpr (AllocTraits::propagate_on_container_swap::value) {
+                using std::swap;
+                swap(alloc_, other.alloc_);
+            }
+            else {
+                assert(alloc_ == other.alloc_);
+            }
+            segments_.Swap(other.segments_);
+            std::swap(size_, other.size_);
+        }
+
+        /**
+         * @brief Calls f(first, count) for every segment holding elements, in index order.
+         * Loops over contiguous segments vectorize better than element-wise iteration.
+         * @param f The callback.
+         */
+        template <typename F>
+        void ForEachSegment(F f) const {
+            for (size_t k = 0; k < segments_.Size() && Layout::SegmentStart(k) < size_; ++k) {
+                f(static_cast<const T*>(segments_[k]), std::min(Layout::SegmentSize(k), size_ - Layout::SegmentStart(k)));
+            }
+        }
+
+    private:
+        [[no_unique_address]] Alloc alloc_;         /*< The allocator of the segments. */
+        Vector<T*, SegmentAlloc> segments_;         /*< The segments, the segment k holds FirstSegment << k elements. */
+        size_t size_ = 0;                           /*< The number of elements. */
+
+        T* Slot(size_t index) noexcept {
+            const size_t k = Layout::SegmentOf(index);
+            return segments_[k] + (index - Layout::SegmentStart(k));
+        }
+
+        void AddSegment() {
+            assert(segments_.Size() < Layout::kMaxSegments);
+            segments_.Reserve(segments_.Size() + 1);
+            segments_.PushBack(AllocTraits::allocate(alloc_, Layout::SegmentSize(segments_.Size())));
+        }
+
+        void FreeSegments(size_t keep) noexcept {
+            while (segments_.Size() > keep) {
+                AllocTraits::deallocate(alloc_, segments_[segments_.Size() - 1], Layout::SegmentSize(segments_.Size() - 1));
+                segments_.PopBack();
+            }
+        }
+
+        /**
+         * @brief Random access iterator over the elements, holding the container and an index.
+         */
+        template <typename Value>
+        class Iterator {
+            public:
+                using iterator_category = std::random_access_iterator_tag;
+                using value_type = std::remove_const_t<Value>;
+                using difference_type = std::ptrdiff_t;
+                using pointer = Value*;
+                using reference = Value&;
+
+                Iterator() = default;
+
+                Iterator(SegmentedVector* owner, size_t index) noexcept : owner_(owner), index_(index) {}
+
+                template <typename Other>
+                    requires (std::is_const_v<Value> && !std::is_const_v<Other>)
+                Iterator(const Iterator<Other>& other) noexcept : owner_(other.owner_), index_(other.index_) {}
+
+                reference operator*() const noexcept {
+                    return (*owner_)[index_];
+                }
+
+                pointer operator->() const noexcept {
+                    return &**this;
+                }
+
+                reference operator[](difference_type n) const noexcept {
+                    return (*owner_)[index_ + n];
+                }
+
+                Iterator& operator++() noexcept {
+                    ++index_;
+                    return *this;
+                }
+
+                Iterator operator++(int) noexcept {
+                    return {owner_, index_++};
+                }
+
+                Iterator& operator--() noexcept {
+                    --index_;
+                    return *this;
+                }
+
+                Iterator operator--(int) noexcept {
+                    return {owner_, index_--};
+                }
+
+                Iterator& operator+=(difference_type n) noexcept {
+                    index_ += n;
+                    return *this;
+                }
+
+                Iterator& operator-=(difference_type n) noexcept {
+                    index_ -= n;
+                    return *this;
+                }
+
+                friend Iterator operator+(Iterator it, difference_type n) noexcept {
+                    return it += n;
+                }
+
+                friend Iterator operator+(difference_type n, Iterator it) noexcept {
+                    return it += n;
+                }
+
+                friend Iterator operator-(Iterator it, difference_type n) noexcept {
+                    return it -= n;
+                }
+
+                friend difference_type operator-(const Iterator& lhs, const Iterator& rhs) noexcept {
+                    return static_cast<difference_type>(lhs.index_) - static_cast<difference_type>(rhs.index_);
+                }
+
+                friend bool operator==(const Iterator& lhs, const Iterator& rhs) noexcept {
+                    return lhs.index_ == rhs.index_;
+                }
+
+                friend auto operator<=>(const Iterator& lhs, const Iterator& rhs) noexcept {
+                    return lhs.index_ <=> rhs.index_;
+                }
+
+            private:
+                friend class SegmentedVector;
+
+                template <typename Other>
+                friend class Iterator;
+
+                SegmentedVector* owner_ = nullptr;
+                size_t index_ = 0;
+        };
+};
@@ -0,0 +1,285 @@
+#pragma once
+
+/**
+ * @file serialization.h
+ * @brief Binary serialization of Vectors of trivially copyable elements.
+ * A serialized Vector is a 32-byte header followed by the raw bytes of its elements, so it is written
+ * and read without touching the elements one by one. The format is not portable between platforms
+ * with different type layouts, a byte order mismatch is detected and rejected.
+ */
+
+#include "vector.h"
+
+#include <bit>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <istream>
+#include <limits>
+#include <ostream>
+#include <span>
+#include <stdexcept>
+#include <system_error>
+
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+/**
+ * @brief The header preceding the elements of a serialized Vector.
+ */
+struct SerializedHeader {
+    static constexpr uint32_t kMagic = 0x53564156; /*< "VAVS" in little-endian order. */
+    static constexpr uint8_t kLittleEndian = 1;
+    static constexpr uint8_t kBigEndian = 2;
+
+    uint32_t magic = kMagic;
+    uint8_t byte_order = std::endian::native == std::endian::little ? kLittleEndian : kBigEndian;
+    uint8_t reserved[3] = {};
+    uint32_t element_size = 0;
+    uint32_t element_alignment = 0;
+    uint64_t count = 0;     /*< The number of elements. */
+    uint64_t padding = 0;   /*< Keeps the elements aligned to 32 bytes behind the header. */
+};
+
+static_assert(sizeof(SerializedHeader) == 32);
+
+namespace detail {
+
+template <typename T>
+SerializedHeader MakeSerializedHeader(size_t count) noexcept {
+    SerializedHeader header;
+    header.element_size = sizeof(T);
+    header.element_alignment = alignof(T);
+    header.count = count;
+    return header;
+}
+
+/**
+ * @brief Checks that a header describes elements of type T written on a platform with the native byte order.
+ * Throws std::runtime_error otherwise.
+ * @param header The header.
+ */
+template <typename T>
+void CheckSerializedHeader(const SerializedHeader& header) {
+    static_assert(std::is_trivially_copyable_v<T>, "Only trivially copyable elements are serialized as raw bytes");
+    static_assert(alignof(T) <= sizeof(SerializedHeader), "The elements follow a 32-byte header");
+
+    if (header.magic != SerializedHeader::kMagic) {
+        throw std::runtime_error("Not a serialized Vector");
+    }
+    if (header.byte_order != SerializedHeader().byte_order) {
+        throw std::runtime_error("The serialized Vector has another byte order");
+    }
+    if (header.element_size != sizeof(T) || header.element_alignment != alignof(T)) {
+        throw std::runtime_error("The serialized Vector holds elements of another type");
+    }
+}
+
+/**
+ * @brief Checks that the elements of a header fit into the bytes left in the input, before they are allocated.
+ * Throws std::runtime_error otherwise, which also rejects counts whose byte size overflows.
+ * @param header The header.
+ * @param available The number of bytes following the header, the maximum of size_t if it is unknown.
+ */
+template <typename T>
+void CheckSerializedCount(const SerializedHeader& header, size_t available) {
+    if (header.count > available / sizeof(T)) {
+        throw std::runtime_error("The serialized Vector is truncated");
+    }
+}
+
+/**
+ * @brief Gets the number of bytes left in a seekable stream.
+ * @return The number of bytes, the maximum of size_t if the stream is not seekable.
+ */
+inline size_t RemainingBytes(std::istream& is) {
+    std::streambuf* buffer = is.rdbuf();
+    const std::streampos position = buffer->pubseekoff(0, std::ios_base::cur, std::ios_base::in);
+    if (position == std::streampos(-1)) {
+        return std::numeric_limits<size_t>::max();
+    }
+    const std::streampos end = buffer->pubseekoff(0, std::ios_base::end, std::ios_base::in);
+    buffer->pubseekpos(position, std::ios_base::in);
+    return end < position ? 0 : static_cast<size_t>(end - position);
+}
+
+/**
+ * @brief Gets the number of bytes left in a regular file.
+ * @return The number of bytes, the maximum of size_t for pipes, sockets and other descriptors.
+ */
+inline size_t RemainingBytes(int fd) noexcept {
+    struct stat status;
+    if (::fstat(fd, &status) != 0 || !S_ISREG(status.st_mode)) {
+        return std::numeric_limits<size_t>::max();
+    }
+    const off_t position = ::lseek(fd, 0, SEEK_CUR);
+    if (position < 0) {
+        return std::numeric_limits<size_t>::max();
+    }
+    return status.st_size < position ? 0 : static_cast<size_t>(status.st_size - position);
+}
+
+/**
+ * @brief Reads exactly size bytes from a file descriptor, retrying partial reads.
+ * Throws std::system_error on failure and std::runtime_error at the end of the file.
+ */
+inline void ReadFully(int fd, void* buffer, size_t size) {
+    char* p = static_cast<char*>(buffer);
+    while (size != 0) {
+        const ssize_t result = ::read(fd, p, size);
+        if (result < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw std::system_error(errno, std::generic_category(), "read");
+        }
+        if (result == 0) {
+            throw std::runtime_error("The serialized Vector is truncated");
+        }
+        p += result;
+        size -= static_cast<size_t>(result);
+    }
+}
+
+}  // namespace detail
+
+/**
+ * @brief Gets the number of bytes Serialize writes for a Vector.
+ * @param v The Vector.
+ * @return The size of the header and the elements.
+ */
+template <typename T, typename Alloc, typename Growth, typename Storage>
+size_t SerializedSize(const Vector<T, Alloc, Growth, Storage>& v) noexcept {
+    return sizeof(SerializedHeader) + v.Size() * sizeof(T);
+}
+
+/**
+ * @brief Writes a Vector to a stream, the header and the elements each with a single write.
+ * @param v The Vector.
+ * @param os The stream, binary mode.
+ */
+template <typename T, typename Alloc, typename Growth, typename Storage>
+void Serialize(const Vector<T, Alloc, Growth, Storage>& v, std::ostream& os) {
+    static_assert(std::is_trivially_copyable_v<T>, "Only trivially copyable elements are serialized as raw bytes");
+
+    const SerializedHeader header = detail::MakeSerializedHeader<T>(v.Size());
+    os.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    os.write(reinterpret_cast<const char*>(v.begin()), static_cast<std::streamsize>(v.Size() * sizeof(T)));
+}
+
+/**
+ * @brief Writes a Vector to a file descriptor, the header and the elements with a single writev.
+ * Partial writes are resumed. Throws std::system_error on failure.
+ * @param v The Vector.
+ * @param fd The file descriptor of a file, a pipe or a socket.
+ */
+template <typename T, typename Alloc, typename Growth, typename Storage>
+void Serialize(const Vector<T, Alloc, Growth, Storage>& v, int fd) {
+    static_assert(std::is_trivially_copyable_v<T>, "Only trivially copyable elements are serialized as raw bytes");
+
+    const SerializedHeader header = detail::MakeSerializedHeader<T>(v.Size());
+    iovec parts[2] = {
+        {const_cast<SerializedHeader*>(&header), sizeof(header)},
+        {const_cast<T*>(v.begin()), v.Size() * sizeof(T)},
+    };
+
+    iovec* part = parts;
+    int count = parts[1].iov_len != 0 ? 2 : 1;
+    while (count != 0) {
+        ssize_t written = ::writev(fd, part, count);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw std::system_error(errno, std::generic_category(), "writev");
+        }
+        while (count != 0 && static_cast<size_t>(written) >= part->iov_len) {
+            written -= static_cast<ssize_t>(part->iov_len);
+            ++part;
+            --count;
+        }
+        if (count != 0) {
+            part->iov_base = static_cast<char*>(part->iov_base) + written;
+            part->iov_len -= static_cast<size_t>(written);
+        }
+    }
+}
+
+/**
+ * @brief Reads a Vector written by Serialize from a stream, replacing the content of v.
+ * The elements are read straight into the storage sized with ResizeDefaultInit.
+ * The count is checked against the bytes left in a seekable stream before anything is allocated.
+ * Throws std::runtime_error if the stream ends early or holds another element type.
+ * @param is The stream, binary mode.
+ * @param v The Vector receiving the elements.
+ */
+template <typename T, typename Alloc, typename Growth, typename Storage>
+void Deserialize(std::istream& is, Vector<T, Alloc, Growth, Storage>& v) {
+    SerializedHeader header;
+    if (!is.read(reinterpret_cast<char*>(&header), sizeof(header))) {
+        throw std::runtime_error("The serialized Vector is truncated");
+    }
+    detail::CheckSerializedHeader<T>(header);
+    detail::CheckSerializedCount<T>(header, detail::RemainingBytes(is));
+
+    v.Clear();
+    v.ResizeDefaultInit(header.count);
+    if (!is.read(reinterpret_cast<char*>(v.begin()), static_cast<std::streamsize>(header.count * sizeof(T)))) {
+        v.Clear();
+        throw std::runtime_error("The serialized Vector is truncated");
+    }
+}
+
+/**
+ * @brief Reads a Vector written by Serialize from a file descriptor, replacing the content of v.
+ * The elements are read straight into the storage sized with ResizeDefaultInit.
+ * The count is checked against the bytes left in a regular file before anything is allocated.
+ * Throws std::system_error if a read fails and std::runtime_error if the data is truncated or holds another element type.
+ * @param fd The file descriptor.
+ * @param v The Vector receiving the elements.
+ */
+template <typename T, typename Alloc, typename Growth, typename Storage>
+void Deserialize(int fd, Vector<T, Alloc, Growth, Storage>& v) {
+    SerializedHeader header;
+    detail::ReadFully(fd, &header, sizeof(header));
+    detail::CheckSerializedHeader<T>(header);
+    detail::CheckSerializedCount<T>(header, detail::RemainingBytes(fd));
+
+    v.Clear();
+    v.ResizeDefaultInit(header.count);
+    try {
+        detail::ReadFully(fd, v.begin(), header.count * sizeof(T));
+    }
+    catch (...) {
+        v.Clear();
+        throw;
+    }
+}
+
+/**
+ * @brief Views the elements of a serialized Vector in an externally owned buffer without copying them.
+ * The buffer must outlive the view and be aligned for T. Throws std::runtime_error if the buffer is
+ * truncated, misaligned or holds another element type.
+ * @param buffer The buffer holding the output of Serialize.
+ * @return A span over the elements inside the buffer.
+ */
+template <typename T>
+std::span<const T> DeserializeView(std::span<const std::byte> buffer) {
+    SerializedHeader header;
+    if (buffer.size() < sizeof(header)) {
+        throw std::runtime_error("The serialized Vector is truncated");
+    }
+    std::memcpy(&header, buffer.data(), sizeof(header));
+    detail::CheckSerializedHeader<T>(header);
+
+    if ((buffer.size() - sizeof(header)) / sizeof(T) < header.count) {
+        throw std::runtime_error("The serialized Vector is truncated");
+    }
+    const std::byte* elements = buffer.data() + sizeof(header);
+    if (reinterpret_cast<uintptr_t>(elements) % alignof(T) != 0) {
+        throw std::runtime_error("The serialized Vector is misaligned");
+    }
+    return {reinterpret_cast<const T*>(elements), static_cast<size_t>(header.count)};
+}
@@ -0,0 +1,374 @@
+#pragma once
+
+/**
+ * @file simd_algorithms.h
+ * @brief Vectorized Find, Count, Sum and MinMax over Vectors and spans of arithmetic types.
+ * The kernels are written with the GCC/Clang vector extensions, so the compiler emits SSE2 or NEON code
+ * for the baseline target. On x86-64 the AVX2 and AVX-512 variants are compiled as well and the widest one
+ * the processor supports is selected at run time. Other compilers and element types use the scalar algorithms.
+ */
+
+#include "vector.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <numeric>
+#include <span>
+#include <utility>
+
+#if defined(__GNUC__)
+#define ADVANCED_VECTOR_SIMD 1
+#if defined(__x86_64__)
+#define ADVANCED_VECTOR_SIMD_DISPATCH 1
+#endif
+#endif
+
+/**
+ * @brief The type Sum returns for elements of type T: 64-bit integers of the same signedness for integral types,
+ * T itself for floating-point types.
+ */
+template <typename T>
+using SumType = std::conditional_t<std::is_integral_v<T>, std::conditional_t<std::is_signed_v<T>, int64_t, uint64_t>, T>;
+
+namespace detail {
+
+/*< Whether the kernels handle elements of type T, the vector extensions need integers or float and double. */
+template <typename T>
+inline constexpr bool kSimdElement = (std::is_integral_v<T> && !std::is_same_v<T, bool>) || std::is_same_v<T, float> || std::is_same_v<T, double>;
+
+#ifdef ADVANCED_VECTOR_SIMD
+
+/**
+ * @brief A vector of Bytes / sizeof(T) lanes of type T.
+ */
+template <typename T, size_t Bytes>
+struct SimdVector {
+    typedef T Type __attribute__((vector_size(Bytes)));
+};
+
+template <typename T, size_t Bytes>
+using SimdLanes = typename SimdVector<T, Bytes>::Type;
+
+/**
+ * @brief Counts the elements equal to a value, Bytes / sizeof(T) lanes at a time.
+ * The lanes count matches in their own width and are flushed every 127 steps, before an 8-bit lane can overflow.
+ */
+struct CountKernel {
+    template <size_t Bytes, typename T>
+    [[gnu::always_inline]] static inline size_t Run(const T* p, size_t n, T value) noexcept {
+        using Lanes = SimdLanes<T, Bytes>;
+        using Mask = decltype(Lanes{} == Lanes{});
+        constexpr size_t kLanes = Bytes / sizeof(T);
+
+        const Lanes needle = value - Lanes{};
+        size_t count = 0;
+        size_t i = 0;
+        while (n - i >= kLanes) {
+            const size_t block_end = i + kLanes * std::min<size_t>(127, (n - i) / kLanes);
+            Mask matches = {};
+            for (; i < block_end; i += kLanes) {
+                Lanes x;
+                std::memcpy(&x, p + i, sizeof(x));
+                matches -= x == needle;
+            }
+            for (size_t lane = 0; lane < kLanes; ++lane) {
+                count += static_cast<size_t>(matches[lane]);
+            }
+        }
+        for (; i < n; ++i) {
+            count += p[i] == value;
+        }
+        return count;
+    }
+};
+
+/**
+ * @brief Finds the first element equal to a value, testing four vectors per step and rescanning only the step with a match.
+ */
+struct FindKernel {
+    template <size_t Bytes, typename T>
+    [[gnu::always_inline]] static inline size_t Run(const T* p, size_t n, T value) noexcept {
+        using Lanes = SimdLanes<T, Bytes>;
+        constexpr size_t kStep = 4 * Bytes / sizeof(T);
+
+        const Lanes needle = value - Lanes{};
+        size_t i = 0;
+        for (; n - i >= kStep; i += kStep) {
+            Lanes x[4];
+            std::memcpy(x, p + i, sizeof(x));
+            const auto matches = (x[0] == needle) | (x[1] == needle) | (x[2] == needle) | (x[3] == needle);
+            uint64_t words[Bytes / sizeof(uint64_t)];
+            std::memcpy(words, &matches, sizeof(words));
+            uint64_t any = 0;
+            for (uint64_t word : words) {
+                any |= word;
+            }
+            if (any != 0) {
+                break;
+            }
+        }
+        for (; i < n; ++i) {
+            if (p[i] == value) {
+                return i;
+            }
+        }
+        return n;
+    }
+};
+
+/**
+ * @brief Sums the elements. Integers are widened to 64-bit lanes and wrap around like unsigned arithmetic,
+ * floating-point values are added in four independent vectors, so the rounding differs from a sequential sum.
+ */
+struct SumKernel {
+    template <size_t Bytes, typename T>
+    [[gnu::always_inline]] static inline SumType<T> Run(const T* p, size_t n) noexcept {
+        using Lanes = SimdLanes<T, Bytes>;
+        constexpr size_t kLanes = Bytes / sizeof(T);
+
+        size_t i = 0;
+        if constexpr (std::is_integral_v<T>) {
+            using Wide = SimdLanes<uint64_t, kLanes * sizeof(uint64_t)>;
+            Wide sum = {};
+            for (; n - i >= kLanes; i += kLanes) {
+                Lanes x;
+                std::memcpy(&x, p + i, sizeof(x));
+                sum += __builtin_convertvector(x, Wide);
+            }
+            uint64_t total = 0;
+            for (size_t lane = 0; lane < kLanes; ++lane) {
+                total += sum[lane];
+            }
+            for (; i < n; ++i) {
+                total += static_cast<uint64_t>(p[i]);
+            }
+            return static_cast<SumType<T>>(total);
+        }
+        else {
+            Lanes sum[4] = {};
+            for (; n - i >= 4 * kLanes; i += 4 * kLanes) {
+                Lanes x[4];
+                std::memcpy(x, p + i, sizeof(x));
+                sum[0] += x[0];
+                sum[1] += x[1];
+                sum[2] += x[2];
+                sum[3] += x[3];
+            }
+            const Lanes lanes = (sum[0] + sum[1]) + (sum[2] + sum[3]);
+            T total = 0;
+            for (size_t lane = 0; lane < kLanes; ++lane) {
+                total += lanes[lane];
+            }
+            for (; i < n; ++i) {
+                total += p[i];
+            }
+            return total;
+        }
+    }
+};
+
+/**
+ * @brief Finds the smallest and the largest element of a non-empty range with per-lane minimums and maximums.
+ */
+struct MinMaxKernel {
+    template <size_t Bytes, typename T>
+    [[gnu::always_inline]] static inline std::pair<T, T> Run(const T* p, size_t n) noexcept {
+        using Lanes = SimdLanes<T, Bytes>;
+        constexpr size_t kLanes = Bytes / sizeof(T);
+
+        T lowest = p[0];
+        T highest = p[0];
+        size_t i = 0;
+        if (n >= kLanes) {
+            Lanes low;
+            std::memcpy(&low, p, sizeof(low));
+            Lanes high = low;
+            for (i = kLanes; n - i >= kLanes; i += kLanes) {
+                Lanes x;
+                std::memcpy(&x, p + i, sizeof(x));
+                low = x < low ? x : low;
+                high = x > high ? x : high;
+            }
+            for (size_t lane = 0; lane < kLanes; ++lane) {
+                lowest = std::min<T>(lowest, low[lane]);
+                highest = std::max<T>(highest, high[lane]);
+            }
+        }
+        for (; i < n; ++i) {
+            lowest = std::min(lowest, p[i]);
+            highest = std::max(highest, p[i]);
+        }
+        return {lowest, highest};
+    }
+};
+
+#ifdef ADVANCED_VECTOR_SIMD_DISPATCH
+
+enum class SimdLevel {
+    BASELINE,
+    AVX2,
+    AVX512,
+};
+
+/**
+ * @brief Gets the widest instruction set the kernels can use on this processor, detected once.
+ */
+inline SimdLevel GetSimdLevel() noexcept {
+    static const SimdLevel level = [] {
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw")) {
+            return SimdLevel::AVX512;
+        }
+        if (__builtin_cpu_supports("avx2")) {
+            return SimdLevel::AVX2;
+        }
+        return SimdLevel::BASELINE;
+    }();
+    return level;
+}
+
+template <typename Kernel, typename... Args>
+[[gnu::target("avx2")]] auto RunAvx2(Args... args) noexcept {
+    return Kernel::template Run<32>(args...);
+}
+
+template <typename Kernel, typename... Args>
+[[gnu::target("avx512f,avx512bw")]] auto RunAvx512(Args... args) noexcept {
+    return Kernel::template Run<64>(args...);
+}
+
+#endif
+
+/**
+ * @brief Runs a kernel with the widest vectors the processor supports.
+ * @param args The arguments of the kernel, passed by value so no vector crosses a call.
+ */
+template <typename Kernel, typename... Args>
+auto RunSimd(Args... args) noexcept {
+#ifdef ADVANCED_VECTOR_SIMD_DISPATCH
+    switch (GetSimdLevel()) {
+        case SimdLevel::AVX512:
+            return RunAvx512<Kernel>(args...);
+        case SimdLevel::AVX2:
+            return RunAvx2<Kernel>(args...);
+        case SimdLevel::BASELINE:
+            break;
+    }
+#endif
+    return Kernel::template Run<16>(args...);
+}
+
+#endif
+
+}  // namespace detail
+
+/**
+ * @brief Finds the first element equal to a value, as std::find.
+ * @param values The elements.
+ * @param value The value to look for.
+ * @return A pointer to the element found, or past the last element.
+ */
+template <typename T>
+    requires std::is_arithmetic_v<T>
+T* Find(std::span<T> values, std::type_identity_t<std::remove_const_t<T>> value) noexcept {
+#ifdef ADVANCED_VECTOR_SIMD
+    if constexpr (detail::kSimdElement<std::remove_const_t<T>>) {
+        return values.data() + detail::RunSimd<detail::FindKernel>(values.data(), values.size(), value);
+    }
+#endif
+    return std::find(values.data(), values.data() + values.size(), value);
+}
+
+/**
+ * @brief Counts the elements equal to a value, as std::count.
+ * @param values The elements.
+ * @param value The value to count.
+ * @return The number of elements equal to value.
+ */
+template <typename T>
+    requires std::is_arithmetic_v<T>
+size_t Count(std::span<T> values, std::type_identity_t<std::remove_const_t<T>> value) noexcept {
+#ifdef ADVANCED_VECTOR_SIMD
+    if constexpr (detail::kSimdElement<std::remove_const_t<T>>) {
+        return detail::RunSimd<detail::CountKernel>(values.data(), values.size(), value);
+    }
+#endif
+    return static_cast<size_t>(std::count(values.begin(), values.end(), value));
+}
+
+/**
+ * @brief Sums the elements. Integers are summed in 64 bits with wrap-around on overflow,
+ * floating-point values are added in several lanes, so the result may be rounded differently than std::accumulate.
+ * @param values The elements.
+ * @return The sum, 0 for no elements.
+ */
+template <typename T>
+    requires std::is_arithmetic_v<T>
+SumType<std::remove_const_t<T>> Sum(std::span<T> values) noexcept {
+    using Value = std::remove_const_t<T>;
+#ifdef ADVANCED_VECTOR_SIMD
+    if constexpr (detail::kSimdElement<Value>) {
+        return detail::RunSimd<detail::SumKernel>(static_cast<const Value*>(values.data()), values.size());
+    }
+#endif
+    if constexpr (std::is_integral_v<Value>) {
+        const uint64_t total = std::accumulate(values.begin(), values.end(), uint64_t(0), [](uint64_t sum, Value value) {
+            return sum + static_cast<uint64_t>(value);
+        });
+        return static_cast<SumType<Value>>(total);
+    }
+    else {
+        return std::accumulate(values.begin(), values.end(), Value(0));
+    }
+}
+
+/**
+ * @brief Finds the smallest and the largest element of a non-empty range.
+ * The result is unspecified if the range holds a NaN.
+ * @param values The elements, at least one.
+ * @return The smallest and the largest value.
+ */
+template <typename T>
+    requires std::is_arithmetic_v<T>
+std::pair<std::remove_const_t<T>, std::remove_const_t<T>> MinMax(std::span<T> values) noexcept {
+    using Value = std::remove_const_t<T>;
+    assert(!values.empty());
+#ifdef ADVANCED_VECTOR_SIMD
+    if constexpr (detail::kSimdElement<Value>) {
+        return detail::RunSimd<detail::MinMaxKernel>(static_cast<const Value*>(values.data()), values.size());
+    }
+#endif
+    const auto [lowest, highest] = std::minmax_element(values.begin(), values.end());
+    return {*lowest, *highest};
+}
+
+template <typename T, typename Alloc, typename Growth, typename Storage>
+    requires std::is_arithmetic_v<T>
+T* Find(Vector<T, Alloc, Growth, Storage>& v, std::type_identity_t<T> value) noexcept {
+    return Find(std::span<T>(v.begin(), v.Size()), value);
+}
+
+template <typename T, typename Alloc, typename Growth, typename Storage>
+    requires std::is_arithmetic_v<T>
+const T* Find(const Vector<T, Alloc, Growth, Storage>& v, std::type_identity_t<T> value) noexcept {
+    return Find(std::span<const T>(v.begin(), v.Size()), value);
+}
+
+template <typename T, typename Alloc, typename Growth, typename Storage>
+    requires std::is_arithmetic_v<T>
+size_t Count(const Vector<T, Alloc, Growth, Storage>& v, std::type_identity_t<T> value) noexcept {
+    return Count(std::span<const T>(v.begin(), v.Size()), value);
+}
+
+template <typename T, typename Alloc, typename Growth, typename Storage>
+    requires std::is_arithmetic_v<T>
+SumType<T> Sum(const Vector<T, Alloc, Growth, Storage>& v) noexcept {
+    return Sum(std::span<const T>(v.begin(), v.Size()));
+}
+
+template <typename T, typename Alloc, typename Growth, typename Storage>
+    requires std::is_arithmetic_v<T>
+std::pair<T, T> MinMax(const Vector<T, Alloc, Growth, Storage>& v) noexcept {
+    return MinMax(std::span<const T>(v.begin(), v.Size()));
+}
@@ -0,0 +1,201 @@
+#pragma once
+
+/**
+ * @file small_vector.h
+ * @brief Definition of the SmallVector class, a Vector that keeps up to N elements inside the object.
+ */
+
+#include "vector.h"
+
+/**
+ * @brief The SmallRawMemory class is a storage for the Vector class with an inline buffer for N elements.
+ * It uses the inline buffer while no heap block is attached and spills to a RawMemory block
+ * once the Vector grows beyond N elements.
+ */
+template <typename T, size_t N, typename Alloc = std::allocator<T>>
+class SmallRawMemory {
+    static_assert(N > 0, "The inline buffer must hold at least one element");
+
+    public:
+        using allocator_type = Alloc;
+
+        static constexpr size_t kInlineCapacity = N;   /*< The number of elements kept without a heap block. */
+
+        /*< Whether TakeFrom and the sized Swap never throw. Inline elements are relocated one by one. */
+        static constexpr bool kNothrowTransfer = std::is_nothrow_move_constructible_v<T> && std::is_nothrow_swappable_v<T>;
+
+        SmallRawMemory() = default;
+
+        /**
+         * @brief Constructs an empty storage bound to the allocator.
+         *
+         * @param alloc The allocator.
+         */
+        explicit SmallRawMemory(const Alloc& alloc) noexcept : heap_(alloc) {}
+
+        /**
+         * @brief Constructor. Allocates a heap block only if the capacity exceeds the inline buffer.
+         *
+         * @param capacity The capacity of the storage.
+         * @param alloc The allocator.
+         */
+        explicit SmallRawMemory(size_t capacity, const Alloc& alloc = Alloc()) : heap_(capacity > N ? capacity : 0, alloc) {}
+
+        SmallRawMemory(const SmallRawMemory&) = delete;
+        SmallRawMemory& operator=(const SmallRawMemory& rhs) = delete;
+
+        T* operator+(size_t offset) noexcept {
+            assert(offset <= Capacity());
+            return GetAddress() + offset;
+        }
+
+        const T* operator+(size_t offset) const noexcept {
+            return const_cast<SmallRawMemory&>(*this) + offset;
+        }
+
+        const T& operator[](size_t index) const noexcept {
+            return const_cast<SmallRawMemory&>(*this)[index];
+        }
+
+        T& operator[](size_t index) noexcept {
+            assert(index < Capacity());
+            return GetAddress()[index];
+        }
+
+        /**
+         * @brief Installs a grown heap block, the previous heap block if any is handed back in block.
+         * @param block The new memory block.
+         */
+        void Swap(RawMemory<T, Alloc>& block) noexcept {
+            heap_.Swap(block);
+        }
+
+        /**
+         * @brief Swaps the content of two storages holding size and other_size live elements.
+         * Heap blocks are swapped as a whole, inline elements are swapped and relocated one by one.
+         * @param other The other SmallRawMemory object.
+         * @param size The number of live elements in this storage.
+         * @param other_size The number of live elements in the other storage.
+         */
+        void Swap(SmallRawMemory& other, size_t size, size_t other_size) noexcept(kNothrowTransfer) {
+            if (IsInline() && other.IsInline()) {
+                if (size < other_size) {
+                    other.Swap(*this, other_size, size);
+                    return;
+                }
+                std::swap_ranges(InlineAddress(), InlineAddress() + other_size, other.InlineAddress());
+                detail::UninitializedRelocateN(heap_.GetAllocator(), InlineAddress() + other_size, size - other_size, other.InlineAddress() + other_size);
+            }
+            else if (IsInline()) {
+                detail::UninitializedRelocateN(heap_.GetAllocator(), InlineAddress(), size, other.InlineAddress());
+            }
+            else if (other.IsInline()) {
+                detail::UninitializedRelocateN(heap_.GetAllocator(), other.InlineAddress(), other_size, InlineAddress());
+            }
+
+            heap_.Swap(other.heap_);
+        }
+
+        /**
+         * @brief Takes over the content of another storage holding size live elements.
+         * The own storage must not hold live elements. A heap block is stolen, inline elements are relocated.
+         * @param other The other SmallRawMemory object, left empty.
+         * @param size The number of live elements in the other storage.
+         */
+        void TakeFrom(SmallRawMemory& other, size_t size) noexcept(kNothrowTransfer) {
+            if (other.IsInline()) {
+                heap_ = RawMemory<T, Alloc>(other.heap_.GetAllocator());
+                detail::UninitializedRelocateN(heap_.GetAllocator(), other.InlineAddress(), size, InlineAddress());
+            }
+            else {
+                heap_ = std::move(other.heap_);
+            }
+        }
+
+        /**
+         * @brief Resizes the storage through the allocator reallocate(), keeping its bytes.
+         * Moves from the inline buffer to a fresh heap block. Usable only with elements that are relocated bitwise.
+         * @param new_capacity The new capacity of the storage, greater than N.
+         * @param size The number of live elements at the start of the storage.
+         */
+        void Reallocate(size_t new_capacity, size_t size) requires detail::kHasReallocate<Alloc, T> {
+            assert(new_capacity > N);
+            if (IsInline()) {
+                RawMemory<T, Alloc> block(new_capacity, heap_.GetAllocator());
+                std::memcpy(static_cast<void*>(block.GetAddress()), static_cast<const void*>(InlineAddress()), size * sizeof(T));
+                detail::RecordRelocation<T>(size);
+                heap_.Swap(block);
+            }
+            else {
+                heap_.Reallocate(new_capacity, size);
+            }
+        }
+
+        /**
+         * @brief Releases the heap block and rebinds the object to another allocator.
+         * @param alloc The new allocator.
+         */
+        void Reset(const Alloc& alloc) noexcept {
+            heap_.Reset(alloc);
+        }
+
+        /**
+         * @brief Gets the address of the elements, the inline buffer unless a heap block is attached.
+         * @return A pointer to the first element.
+         */
+        const T* GetAddress() const noexcept {
+            return const_cast<SmallRawMemory&>(*this).GetAddress();
+        }
+
+        T* GetAddress() noexcept {
+            return IsInline() ? InlineAddress() : heap_.GetAddress();
+        }
+
+        /**
+         * @brief Gets the capacity of the storage, N while the inline buffer is used.
+         * @return The capacity of the storage.
+         */
+        size_t Capacity() const noexcept {
+            return IsInline() ? N : heap_.Capacity();
+        }
+
+        /**
+         * @brief Tells whether the elements live in the inline buffer.
+         * @return True if no heap block is attached.
+         */
+        bool IsInline() const noexcept {
+            return heap_.GetAddress() == nullptr;
+        }
+
+        /**
+         * @brief Tells whether the heap block was adopted with a deleter, see RawMemory::Adopt.
+         * @return True if the heap block is released by a deleter.
+         */
+        bool IsAdopted() const noexcept {
+            return heap_.IsAdopted();
+        }
+
+        const Alloc& GetAllocator() const noexcept {
+            return heap_.GetAllocator();
+        }
+
+        Alloc& GetAllocator() noexcept {
+            return heap_.GetAllocator();
+        }
+
+    private:
+        RawMemory<T, Alloc> heap_; /*< The heap block, empty while the inline buffer is used. */
+        alignas(T) unsigned char inline_[N * sizeof(T)]; /*< The inline buffer. */
+
+        T* InlineAddress() noexcept {
+            return reinterpret_cast<T*>(inline_);
+        }
+};
+
+/**
+ * @brief The SmallVector class is a Vector that stores up to N elements inline and allocates only beyond that.
+ * It has the interface and the exception guarantees of Vector. Moving and swapping inline
+ * elements relocates them one by one instead of exchanging pointers.
+ */
+template <typename T, size_t N, typename Alloc = std::allocator<T>, typename Growth = DoublingGrowth<>>
+using SmallVector = Vector<T, Alloc, Growth, SmallRawMemory<T, N, Alloc>>;
@@ -0,0 +1,434 @@
+#pragma once
+
+/**
+ * @file soa_vector.h
+ * @brief Definition of the SoAVector class, a vector of records stored as one contiguous column per field.
+ */
+
+#include "vector.h"
+
+#include <compare>
+#include <span>
+#include <tuple>
+
+/**
+ * @brief The SoAVector class stores records in the structure-of-arrays layout: each field lives in its own
+ * RawMemory column, so a loop reading a few fields only streams those columns through the cache and
+ * vectorizes over plain arrays. All columns share the size and the capacity and grow together.
+ *
+ * A record is accessed as a tuple of references, operator[] and the iterators return it by value,
+ * so the iterators are random-access in the C++20 iterator_concept sense but only input iterators
+ * in the legacy sense. SoAVector<std::tuple<Fields...>> is the same as SoAVector<Fields...>.
+ * @tparam Fields The types of the fields.
+ */
+template <typename... Fields>
+class SoAVector {
+    static_assert(sizeof...(Fields) > 0, "A record needs at least one field");
+
+    using Columns = std::tuple<RawMemory<Fields>...>;
+    using Indices = std::index_sequence_for<Fields...>;
+
+    /*< Whether growing can relocate the columns one by one without a way back. */
+    static constexpr bool kNothrowRelocate = (std::is_nothrow_move_constructible_v<Fields> && ...);
+
+    template <bool Const>
+    class Iterator;
+
+    public:
+        using value_type = std::tuple<Fields...>;
+        using reference = std::tuple<Fields&...>;
+        using const_reference = std::tuple<const Fields&...>;
+        using iterator = Iterator<false>;
+        using const_iterator = Iterator<true>;
+
+        template <size_t I>
+        using FieldType = std::tuple_element_t<I, value_type>;
+
+        SoAVector() = default;
+
+        /**
+         * @brief Constructs a SoAVector of value-initialized records.
+         * @param size The initial size.
+         */
+        explicit SoAVector(size_t size) {
+            Resize(size);
+        }
+
+        /**
+         * @brief Copy constructor, allocates each column to the exact size.
+         * @param other The other SoAVector object to copy from.
+         */
+        SoAVector(const SoAVector& other) : columns_(RawMemory<Fields>(other.size_)...) {
+            CopyColumns(other, Indices{});
+            size_ = other.size_;
+        }
+
+        SoAVector(SoAVector&& other) noexcept : columns_(std::move(other.columns_)), size_(std::exchange(other.size_, 0)) {}
+
+        /**
+         * @brief Copy assignment operator, gives the strong guarantee.
+         * @param rhs The other SoAVector object to copy from.
+         * @return A reference to the current SoAVector object.
+         */
+        SoAVector& operator=(const SoAVector& rhs) {
+            if (this != &rhs) {
+                SoAVector copy(rhs);
+                Swap(copy);
+            }
+            return *this;
+        }
+
+        SoAVector& operator=(SoAVector&& rhs) noexcept {
+            if (this != &rhs) {
+                Clear();
+                columns_ = std::move(rhs.columns_);
+                size_ = std::exchange(rhs.size_, 0);
+            }
+            return *this;
+        }
+
+        ~SoAVector() {
+            Clear();
+        }
+
+        iterator begin() noexcept {
+            return {this, 0};
+        }
+
+        iterator end() noexcept {
+            return {this, size_};
+        }
+
+        const_iterator begin() const noexcept {
+            return {this, 0};
+        }
+
+        const_iterator end() const noexcept {
+            return {this, size_};
+        }
+
+        const_iterator cbegin() const noexcept {
+            return begin();
+        }
+
+        const_iterator cend() const noexcept {
+            return end();
+        }
+
+        size_t Size() const noexcept {
+            return size_;
+        }
+
+        size_t Capacity() const noexcept {
+            return std::get<0>(columns_).Capacity();
+        }
+
+        /**
+         * @brief Gets the contiguous column of the field I.
+         * @tparam I The index of the field.
+         * @return A span over the values of the field, one per record.
+         */
+        template <size_t I>
+        std::span<FieldType<I>> Column() noexcept {
+            return {std::get<I>(columns_).GetAddress(), size_};
+        }
+
+        template <size_t I>
+        std::span<const FieldType<I>> Column() const noexcept {
+            return {std::get<I>(columns_).GetAddress(), size_};
+        }
+
+        /**
+         * @brief Gets the record at the index.
+         * @param index The index of the record.
+         * @return A tuple of references to the fields of the record.
+         */
+        reference operator[](size_t index) noexcept {
+            assert(index < size_);
+            return std::apply([index](auto&... columns) { return reference(columns[index]...); }, columns_);
+        }
+
+        const_reference operator[](size_t index) const noexcept {
+            assert(index < size_);
+            return std::apply([index](const auto&... columns) { return const_reference(columns[index]...); }, columns_);
+        }
+
+        /**
+         * @brief Reserves room for new_capacity records in every column.
+         * Gives the strong guarantee, the columns are relocated one after another.
+         * @param new_capacity The new capacity to reserve.
+         */
+        void Reserve(size_t new_capacity) {
+            if (new_capacity > Capacity()) {
+                Columns fresh{RawMemory<Fields>(new_capacity)...};
+                RelocateColumns(fresh, Indices{});
+            }
+        }
+
+        /**
+         * @brief Resizes the SoAVector, the fields of new records are value-initialized.
+         * @param new_size The new size.
+         */
+        void Resize(size_t new_size) {
+            Reserve(new_size);
+            while (size_ < new_size) {
+                EmplaceBack();
+            }
+            while (size_ > new_size) {
+                PopBack();
+            }
+        }
+
+        /**
+         * @brief Appends a record, constructing each field from its own argument.
+         * The arguments may refer to records of the SoAVector itself.
+         * @param fields The values of the fields in order, or none to value-initialize them.
+         * @return A tuple of references to the fields of the new record.
+         */
+        template <typename... Args>
+            requires (sizeof...(Args) == sizeof...(Fields) || sizeof...(Args) == 0)
+        reference EmplaceBack(Args&&... fields) {
+            if (size_ == Capacity()) {
+                Columns fresh{RawMemory<Fields>(DoublingGrowth<>::NextCapacity(Capacity(), size_ + 1, kRecordSize))...};
+                ConstructRow(fresh, size_, Indices{}, std::forward<Args>(fields)...);
+                try {
+                    RelocateColumns(fresh, Indices{});
+                }
+                catch (...) {
+                    DestroyRow(fresh, size_, Indices{});
+                    throw;
+                }
+            }
+            else {
+                ConstructRow(columns_, size_, Indices{}, std::forward<Args>(fields)...);
+            }
+            return (*this)[size_++];
+        }
+
+        void PushBack(const value_type& record) {
+            std::apply([this](const Fields&... fields) { EmplaceBack(fields...); }, record);
+        }
+
+        void PushBack(value_type&& record) {
+            std::apply([this](Fields&... fields) { EmplaceBack(std::move(fields)...); }, record);
+        }
+
+        void PopBack() noexcept {
+            assert(size_ != 0);
+            DestroyRow(columns_, --size_, Indices{});
+        }
+
+        /**
+         * @brief Erases the record at the position, shifting the following records of every column down.
+         * @param pos The position of the record to erase.
+         * @return An iterator pointing to the record following the erased one.
+         */
+        iterator Erase(const_iterator pos) {
+            assert(pos.index_ < size_);
+            const size_t index = pos.index_;
+            std::apply([this, index](auto&... columns) {
+                (std::move(columns.GetAddress() + index + 1, columns.GetAddress() + size_, columns.GetAddress() + index), ...);
+            }, columns_);
+            PopBack();
+            return {this, index};
+        }
+
+        /**
+         * @brief Destroys all records, the capacity is kept.
+         */
+        void Clear() noexcept {
+            std::apply([this](auto&... columns) {
+                (detail::DestroyN(columns.GetAllocator(), columns.GetAddress(), size_), ...);
+            }, columns_);
+            size_ = 0;
+        }
+
+        void Swap(SoAVector& other) noexcept {
+            SwapColumns(other, Indices{});
+            std::swap(size_, other.size_);
+        }
+
+    private:
+        static constexpr size_t kRecordSize = (sizeof(Fields) + ...);
+
+        Columns columns_;   /*< The columns, one per field. */
+        size_t size_ = 0;   /*< The number of records. */
+
+        template <size_t... I>
+        void SwapColumns(SoAVector& other, std::index_sequence<I...>) noexcept {
+            (std::get<I>(columns_).Swap(std::get<I>(other.columns_)), ...);
+        }
+
+        /**
+         * @brief Constructs the fields of the record at the index, destroying the constructed ones if a constructor throws.
+         */
+        template <size_t... I, typename... Args>
+        static void ConstructRow(Columns& columns, size_t index, std::index_sequence<I...>, Args&&... fields) {
+            size_t constructed = 0;
+            try {
+                if constexpr (sizeof...(Args) == 0) {
+                    ((detail::UninitializedValueConstructN(std::get<I>(columns).GetAllocator(), std::get<I>(columns) + index, 1), ++constructed), ...);
+                }
+                else {
+                    ((detail::ConstructAt(std::get<I>(columns).GetAllocator(), std::get<I>(columns) + index, std::forward<Args>(fields)), ++constructed), ...);
+                }
+            }
+            catch (...) {
+                ((I < constructed ? detail::DestroyAt(std::get<I>(columns).GetAllocator(), std::get<I>(columns) + index) : void()), ...);
+                throw;
+            }
+        }
+
+        template <size_t... I>
+        static void DestroyRow(Columns& columns, size_t index, std::index_sequence<I...>) noexcept {
+            (detail::DestroyAt(std::get<I>(columns).GetAllocator(), std::get<I>(columns) + index), ...);
+        }
+
+        /**
+         * @brief Copies the records of other into the allocated columns, destroying the copied columns if a copy throws.
+         */
+        template <size_t... I>
+        void CopyColumns(const SoAVector& other, std::index_sequence<I...>) {
+            size_t copied = 0;
+            try {
+                ((detail::UninitializedCopyN(std::get<I>(columns_).GetAllocator(), std::get<I>(other.columns_).GetAddress(), other.size_,
+                                             std::get<I>(columns_).GetAddress()), ++copied), ...);
+            }
+            catch (...) {
+                ((I < copied ? detail::DestroyN(std::get<I>(columns_).GetAllocator(), std::get<I>(columns_).GetAddress(), other.size_) : void()), ...);
+                throw;
+            }
+        }
+
+        /**
+         * @brief Moves the records into the fresh columns and makes them the current ones.
+         * If every field moves without throwing the columns are relocated, otherwise the records are
+         * moved or copied with the old columns kept alive until the last one succeeds.
+         * @param fresh The fresh columns with room for the records, swapped with the old ones on return.
+         */
+        template <size_t... I>
+        void RelocateColumns(Columns& fresh, std::index_sequence<I...>) {
+            if constexpr (kNothrowRelocate) {
+                (detail::UninitializedRelocateN(std::get<I>(columns_).GetAllocator(), std::get<I>(columns_).GetAddress(), size_,
+                                                std::get<I>(fresh).GetAddress()), ...);
+            }
+            else {
+                size_t moved = 0;
+                try {
+                    ((detail::UninitializedMoveIfNoexceptN(std::get<I>(columns_).GetAllocator(), std::get<I>(columns_).GetAddress(), size_,
+                                                           std::get<I>(fresh).GetAddress()), ++moved), ...);
+                }
+                catch (...) {
+                    ((I < moved ? detail::DestroyN(std::get<I>(fresh).GetAllocator(), std::get<I>(fresh).GetAddress(), size_) : void()), ...);
+                    throw;
+                }
+                (detail::DestroyN(std::get<I>(columns_).GetAllocator(), std::get<I>(columns_).GetAddress(), size_), ...);
+            }
+            columns_.swap(fresh);
+        }
+};
+
+/**
+ * @brief A random-access iterator over the records of a SoAVector, dereferences to a tuple of references.
+ */
+template <typename... Fields>
+template <bool Const>
+class SoAVector<Fields...>::Iterator {
+    using Owner = std::conditional_t<Const, const SoAVector, SoAVector>;
+
+    public:
+        using iterator_concept = std::random_access_iterator_tag;
+        using iterator_category = std::input_iterator_tag;
+        using value_type = SoAVector::value_type;
+        using difference_type = std::ptrdiff_t;
+        using reference = std::conditional_t<Const, SoAVector::const_reference, SoAVector::reference>;
+        using pointer = void;
+
+        Iterator() = default;
+
+        Iterator(Owner* owner, size_t index) noexcept : owner_(owner), index_(index) {}
+
+        template <bool OtherConst>
+            requires (Const && !OtherConst)
+        Iterator(const Iterator<OtherConst>& other) noexcept : owner_(other.owner_), index_(other.index_) {}
+
+        reference operator*() const noexcept {
+            return (*owner_)[index_];
+        }
+
+        reference operator[](difference_type n) const noexcept {
+            return (*owner_)[index_ + n];
+        }
+
+        Iterator& operator++() noexcept {
+            ++index_;
+            return *this;
+        }
+
+        Iterator operator++(int) noexcept {
+            Iterator copy = *this;
+            ++index_;
+            return copy;
+        }
+
+        Iterator& operator--() noexcept {
+            --index_;
+            return *this;
+        }
+
+        Iterator operator--(int) noexcept {
+            Iterator copy = *this;
+            --index_;
+            return copy;
+        }
+
+        Iterator& operator+=(difference_type n) noexcept {
+            index_ += n;
+            return *this;
+        }
+
+        Iterator& operator-=(difference_type n) noexcept {
+            index_ -= n;
+            return *this;
+        }
+
+        friend Iterator operator+(Iterator it, difference_type n) noexcept {
+            return it += n;
+        }
+
+        friend Iterator operator+(difference_type n, Iterator it) noexcept {
+            return it += n;
+        }
+
+        friend Iterator operator-(Iterator it, difference_type n) noexcept {
+            return it -= n;
+        }
+
+        friend difference_type operator-(const Iterator& lhs, const Iterator& rhs) noexcept {
+            return static_cast<difference_type>(lhs.index_) - static_cast<difference_type>(rhs.index_);
+        }
+
+        friend bool operator==(const Iterator& lhs, const Iterator& rhs) noexcept {
+            return lhs.index_ == rhs.index_;
+        }
+
+        friend auto operator<=>(const Iterator& lhs, const Iterator& rhs) noexcept {
+            return lhs.index_ <=> rhs.index_;
+        }
+
+    private:
+        friend class SoAVector;
+        friend class Iterator<!Const>;
+
+        Owner* owner_ = nullptr;    /*< The SoAVector. */
+        size_t index_ = 0;          /*< The index of the record. */
+};
+
+/**
+ * @brief Takes the fields of a SoAVector from a tuple type, SoAVector<std::tuple<int, double>> is SoAVector<int, double>.
+ */
+template <typename... Fields>
+class SoAVector<std::tuple<Fields...>> : public SoAVector<Fields...> {
+    public:
+        using SoAVector<Fields...>::SoAVector;
+};
@@ -11,27 +11,512 @@
 #include <new>
 #include <utility>
 #include <iterator>
+#include <cstddef>
 #include <cstdlib>
+#include <cstring>
+#include <concepts>
+#include <compare>
+#include <type_traits>
+#include <exception>
+#include <thread>
+
+#ifdef ADVANCED_VECTOR_STATS
+#include "vector_stats.h"
+#endif
+
+/**
+ * @brief Tells whether an object can be relocated by copying its bytes to a new address
+ * and forgetting the source without running its destructor.
+ * Trivially copyable types qualify by default, specialize the template for other types with the same property.
+ */
+template <typename T>
+struct IsTriviallyRelocatable : std::is_trivially_copyable<T> {};
+
+template <typename T, typename Deleter>
+struct IsTriviallyRelocatable<std::unique_ptr<T, Deleter>> : IsTriviallyRelocatable<Deleter> {};
+
+/**
+ * @brief Tag selecting the multithreaded overloads of the Vector constructors, Assign and Reserve.
+ * They split the elements into chunks filled by worker threads, so each thread also first-touches
+ * the pages of its chunk. The allocator construct() and destroy() must be safe to call concurrently.
+ */
+struct ParallelTag {
+    unsigned max_threads = 0; /*< The maximum number of threads, 0 means std::thread::hardware_concurrency(). */
+};
+
+inline constexpr ParallelTag Parallel{};
+
+namespace detail {
+
+#ifndef ADVANCED_VECTOR_STATS
+// The instrumentation hooks are no-ops unless ADVANCED_VECTOR_STATS is defined, see vector_stats.h
+
+template <typename T>
+constexpr void RecordCapacity(size_t) noexcept {}
+
+template <typename T>
+constexpr void RecordAllocation(size_t) noexcept {}
+
+template <typename T>
+constexpr void RecordDeallocation() noexcept {}
+
+template <typename T>
+constexpr void RecordRelocation(size_t) noexcept {}
+
+template <typename T>
+constexpr void RecordRetirement(size_t, size_t) noexcept {}
+#endif
+
+/**
+ * @brief True when the allocator construct()/destroy() are the std::allocator_traits defaults.
+ * Such allocators are served by the plain std::uninitialized_* algorithms.
+ */
+template <typename Alloc, typename T>
+inline constexpr bool kUsesDefaultConstruct = !requires(Alloc& alloc, T* p) { alloc.construct(p); }
+    && !requires(Alloc& alloc, T* p, const T& value) { alloc.construct(p, value); }
+    && !requires(Alloc& alloc, T* p) { alloc.destroy(p); };
+
+/**
+ * @brief Constructs an element in uninitialized memory through the allocator.
+ * @param alloc The allocator.
+ * @param p The address of the element.
+ * @param args The arguments to forward to the constructor.
+ */
+template <typename Alloc, typename T, typename... Args>
+void ConstructAt(Alloc& alloc, T* p, Args&&... args) {
+    std::allocator_traits<Alloc>::construct(alloc, p, std::forward<Args>(args)...);
+}
+
+/**
+ * @brief Destroys an element through the allocator.
+ * @param alloc The allocator.
+ * @param p The address of the element.
+ */
+template <typename Alloc, typename T>
+void DestroyAt(Alloc& alloc, T* p) noexcept {
+    std::allocator_traits<Alloc>::destroy(alloc, p);
+}
+
+/**
+ * @brief Destroys n elements starting at first through the allocator.
+ * @param alloc The allocator.
+ * @param first The address of the first element.
+ * @param n The number of elements.
+ */
+template <typename Alloc, typename T>
+void DestroyN(Alloc& alloc, T* first, size_t n) noexcept {
+    if constexpr (kUsesDefaultConstruct<Alloc, T>) {
+        std::destroy_n(first, n);
+    }
+    else {
+        for (; n > 0; --n, ++first) {
+            DestroyAt(alloc, first);
+        }
+    }
+}
+
+/**
+ * @brief Value-constructs n elements in uninitialized memory.
+ * If a constructor throws, the already constructed elements are destroyed.
+ * @param alloc The allocator.
+ * @param first The address of the first element.
+ * @param n The number of elements.
+ */
+template <typename Alloc, typename T>
+void UninitializedValueConstructN(Alloc& alloc, T* first, size_t n) {
+    if constexpr (kUsesDefaultConstruct<Alloc, T>) {
+        std::uninitialized_value_construct_n(first, n);
+    }
+    else {
+        size_t constructed = 0;
+        try {
+            for (; constructed < n; ++constructed) {
+                ConstructAt(alloc, first + constructed);
+            }
+        }
+        catch (...) {
+            DestroyN(alloc, first, constructed);
+            throw;
+        }
+    }
+}
+
+/**
+ * @brief Default-initializes n elements in uninitialized memory, leaving trivial types unset.
+ * Allocators that customize construction still see every element, value-constructed.
+ * @param alloc The allocator.
+ * @param first The address of the first element.
+ * @param n The number of elements.
+ */
+template <typename Alloc, typename T>
+void UninitializedDefaultConstructN(Alloc& alloc, T* first, size_t n) {
+    if constexpr (kUsesDefaultConstruct<Alloc, T>) {
+        std::uninitialized_default_construct_n(first, n);
+    }
+    else {
+        UninitializedValueConstructN(alloc, first, n);
+    }
+}
+
+/**
+ * @brief Copy-constructs n elements from src into uninitialized memory at dst.
+ * If a constructor throws, the already constructed elements are destroyed.
+ * @param alloc The allocator.
+ * @param src The iterator to the first source element.
+ * @param n The number of elements.
+ * @param dst The address of the first destination element.
+ * @return A pointer past the last constructed element.
+ */
+template <typename Alloc, typename InputIt, typename T>
+T* UninitializedCopyN(Alloc& alloc, InputIt src, size_t n, T* dst) {
+    if constexpr (kUsesDefaultConstruct<Alloc, T>) {
+        return std::uninitialized_copy_n(src, n, dst);
+    }
+    else {
+        size_t constructed = 0;
+        try {
+            for (; constructed < n; ++constructed, ++src) {
+                ConstructAt(alloc, dst + constructed, *src);
+            }
+        }
+        catch (...) {
+            DestroyN(alloc, dst, constructed);
+            throw;
+        }
+        return dst + n;
+    }
+}
+
+/**
+ * @brief Moves n elements into uninitialized memory if the move constructor can not throw,
+ * copies them otherwise. The source elements are left alive.
+ * @param alloc The allocator.
+ * @param src The address of the first source element.
+ * @param n The number of elements.
+ * @param dst The address of the first destination element.
+ */
+template <typename Alloc, typename T>
+void UninitializedMoveIfNoexceptN(Alloc& alloc, T* src, size_t n, T* dst) {
+    if constexpr (std::is_nothrow_move_constructible_v<T> || !std::is_copy_constructible_v<T>) {
+        UninitializedCopyN(alloc, std::make_move_iterator(src), n, dst);
+    }
+    else {
+        UninitializedCopyN(alloc, src, n, dst);
+    }
+}
+
+/**
+ * @brief Forward iterator yielding the same value forever, a source for inserting copies of one value.
+ */
+template <typename T>
+class RepeatIterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const T*;
+        using reference = const T&;
+
+        RepeatIterator() = default;
+
+        explicit RepeatIterator(const T& value) noexcept : value_(&value) {}
+
+        reference operator*() const noexcept {
+            return *value_;
+        }
+
+        RepeatIterator& operator++() noexcept {
+            return *this;
+        }
+
+        RepeatIterator operator++(int) noexcept {
+            return *this;
+        }
+
+        bool operator==(const RepeatIterator& other) const noexcept = default;
+
+    private:
+        const T* value_ = nullptr;
+};
+
+/**
+ * @brief True when the allocator can resize a block keeping its bytes, see MallocAllocator.
+ */
+template <typename Alloc, typename T>
+inline constexpr bool kHasReallocate = requires(Alloc& alloc, T* p, size_t n) { { alloc.reallocate(p, n, n) } -> std::same_as<T*>; };
+
+/**
+ * @brief The number of elements a storage keeps without a heap block, its kInlineCapacity or 0.
+ */
+template <typename Storage>
+inline constexpr size_t kInlineCapacity = 0;
+
+template <typename Storage>
+    requires requires { Storage::kInlineCapacity; }
+inline constexpr size_t kInlineCapacity<Storage> = Storage::kInlineCapacity;
+
+/**
+ * @brief True when elements can be relocated with memcpy: the type is trivially relocatable
+ * and the allocator does not observe construction and destruction.
+ */
+template <typename Alloc, typename T>
+inline constexpr bool kRelocatesBitwise = IsTriviallyRelocatable<T>::value && kUsesDefaultConstruct<Alloc, T>;
+
+/**
+ * @brief Relocates n elements from src into uninitialized memory at dst, the source elements are destroyed.
+ * If an exception is thrown, nothing is constructed at dst and the source elements are left intact.
+ * @param alloc The allocator.
+ * @param src The address of the first source element.
+ * @param n The number of elements.
+ * @param dst The address of the first destination element.
+ */
+template <typename Alloc, typename T>
+void UninitializedRelocateN(Alloc& alloc, T* src, size_t n, T* dst) {
+    if constexpr (kRelocatesBitwise<Alloc, T>) {
+        if (n != 0) {
+            std::memcpy(static_cast<void*>(dst), static_cast<const void*>(src), n * sizeof(T));
+        }
+    }
+    else {
+        UninitializedMoveIfNoexceptN(alloc, src, n, dst);
+        DestroyN(alloc, src, n);
+    }
+}
+
+/*< Runs the parallel overloads on the calling thread, used by their sequential counterparts. */
+inline constexpr ParallelTag kSingleThread{1};
+
+/*< Chunks smaller than this are not worth starting a thread. */
+inline constexpr size_t kParallelGrainBytes = size_t(1) << 20;
+
+/**
+ * @brief Calls op(offset, count) for the chunks of the index range [0, n), one chunk per thread,
+ * the first chunk runs on the calling thread. op must leave nothing behind when it throws.
+ * If any chunk throws, undo(offset, count) is called for the completed chunks and the first exception
+ * is rethrown, so the whole call leaves nothing behind either. A chunk whose thread can not be started
+ * runs on the calling thread.
+ * @param policy The parallel policy.
+ * @param n The number of elements.
+ * @param op The operation over a chunk.
+ * @param undo The operation reverting a completed chunk.
+ */
+template <typename T, typename Op, typename Undo>
+void ParallelForChunks(ParallelTag policy, size_t n, Op op, Undo undo) {
+    const size_t max_threads = policy.max_threads != 0 ? policy.max_threads : std::max(1u, std::thread::hardware_concurrency());
+    const size_t grain = std::max<size_t>(1, kParallelGrainBytes / sizeof(T));
+    const size_t chunks = std::min(max_threads, n / grain);
+    if (chunks <= 1) {
+        op(size_t(0), n);
+        return;
+    }
+
+    const auto chunk_offset = [n, chunks](size_t chunk) {
+        return n / chunks * chunk + std::min(chunk, n % chunks);
+    };
+    const auto chunk_count = [n, chunks](size_t chunk) {
+        return n / chunks + (chunk < n % chunks ? 1 : 0);
+    };
+    std::unique_ptr<std::exception_ptr[]> errors(new std::exception_ptr[chunks]);
+    const auto run = [&](size_t chunk) noexcept {
+        try {
+            op(chunk_offset(chunk), chunk_count(chunk));
+        }
+        catch (...) {
+            errors[chunk] = std::current_exception();
+        }
+    };
+
+    std::unique_ptr<std::thread[]> threads(new std::thread[chunks - 1]);
+    for (size_t chunk = 1; chunk < chunks; ++chunk) {
+        try {
+            threads[chunk - 1] = std::thread(run, chunk);
+        }
+        catch (...) {
+            run(chunk);
+        }
+    }
+    run(0);
+    for (size_t i = 0; i + 1 < chunks; ++i) {
+        if (threads[i].joinable()) {
+            threads[i].join();
+        }
+    }
+
+    std::exception_ptr error;
+    for (size_t chunk = 0; chunk < chunks; ++chunk) {
+        if (errors[chunk] != nullptr && error == nullptr) {
+            error = errors[chunk];
+        }
+    }
+    if (error != nullptr) {
+        for (size_t chunk = 0; chunk < chunks; ++chunk) {
+            if (errors[chunk] == nullptr) {
+                undo(chunk_offset(chunk), chunk_count(chunk));
+            }
+        }
+        std::rethrow_exception(error);
+    }
+}
+
+/**
+ * @brief UninitializedValueConstructN split across threads, see ParallelForChunks.
+ */
+template <typename Alloc, typename T>
+void ParallelUninitializedValueConstructN(ParallelTag policy, Alloc& alloc, T* first, size_t n) {
+    ParallelForChunks<T>(policy, n,
+        [&alloc, first](size_t offset, size_t count) { UninitializedValueConstructN(alloc, first + offset, count); },
+        [&alloc, first](size_t offset, size_t count) { DestroyN(alloc, first + offset, count); });
+}
+
+/**
+ * @brief UninitializedCopyN split across threads, see ParallelForChunks.
+ */
+template <typename Alloc, typename RandomIt, typename T>
+void ParallelUninitializedCopyN(ParallelTag policy, Alloc& alloc, RandomIt src, size_t n, T* dst) {
+    ParallelForChunks<T>(policy, n,
+        [&alloc, src, dst](size_t offset, size_t count) { UninitializedCopyN(alloc, src + offset, count, dst + offset); },
+        [&alloc, dst](size_t offset, size_t count) { DestroyN(alloc, dst + offset, count); });
+}
+
+/**
+ * @brief std::copy_n over constructed elements split across threads.
+ * If an assignment throws, the elements are left partially assigned.
+ */
+template <typename RandomIt, typename T>
+void ParallelCopyN(ParallelTag policy, RandomIt src, size_t n, T* dst) {
+    ParallelForChunks<T>(policy, n,
+        [src, dst](size_t offset, size_t count) { std::copy_n(src + offset, count, dst + offset); },
+        [](size_t, size_t) {});
+}
+
+/**
+ * @brief UninitializedRelocateN split across threads, see ParallelForChunks.
+ * The source elements are destroyed only after all of them were relocated, so they are left intact
+ * if an exception is thrown.
+ */
+template <typename Alloc, typename T>
+void ParallelUninitializedRelocateN(ParallelTag policy, Alloc& alloc, T* src, size_t n, T* dst) {
+    if constexpr (kRelocatesBitwise<Alloc, T>) {
+        ParallelForChunks<T>(policy, n,
+            [&alloc, src, dst](size_t offset, size_t count) { UninitializedRelocateN(alloc, src + offset, count, dst + offset); },
+            [](size_t, size_t) {});
+    }
+    else {
+        ParallelForChunks<T>(policy, n,
+            [&alloc, src, dst](size_t offset, size_t count) { UninitializedMoveIfNoexceptN(alloc, src + offset, count, dst + offset); },
+            [&alloc, dst](size_t offset, size_t count) { DestroyN(alloc, dst + offset, count); });
+        ParallelForChunks<T>(policy, n,
+            [&alloc, src](size_t offset, size_t count) { DestroyN(alloc, src + offset, count); },
+            [](size_t, size_t) {});
+    }
+}
+
+/**
+ * @brief Releases a memory block adopted by a RawMemory object, erasing the type of the deleter.
+ */
+template <typename T>
+struct AdoptedBlock {
+    virtual ~AdoptedBlock() = default;
+    virtual void Release(T* buffer) noexcept = 0;
+};
+
+template <typename T, typename Deleter>
+struct AdoptedBlockWith final : AdoptedBlock<T> {
+    explicit AdoptedBlockWith(Deleter deleter) : deleter(std::move(deleter)) {}
+
+    void Release(T* buffer) noexcept override {
+        deleter(buffer);
+    }
+
+    Deleter deleter;
+};
+
+/**
+ * @brief Tells whether a range can be traversed several times.
+ * Unlike std::forward_iterator it accepts std::move_iterator over a forward iterator through its legacy
+ * iterator category, C++20 makes move_iterator an input iterator only.
+ */
+template <typename It>
+concept MultiPassIterator = std::forward_iterator<It>
+    || std::derived_from<typename std::iterator_traits<It>::iterator_category, std::forward_iterator_tag>;
+
+template <typename It>
+concept BidirectionalIterator = std::bidirectional_iterator<It>
+    || std::derived_from<typename std::iterator_traits<It>::iterator_category, std::bidirectional_iterator_tag>;
+
+/*< Whether equal elements of type T have equal bytes and equal bytes mean equal elements, so memcmp decides equality. */
+template <typename T>
+inline constexpr bool kBitwiseComparable = (std::is_integral_v<T> || std::is_enum_v<T>) && std::has_unique_object_representations_v<T>;
+
+/*< Whether memcmp orders elements of type T the way their operator<=> does. */
+template <typename T>
+inline constexpr bool kBytewiseOrdered = sizeof(T) == 1 && (std::is_unsigned_v<T> || std::is_same_v<T, std::byte>);
+
+/**
+ * @brief Finds the index of the first pair of different elements,
+ * skipping equal blocks of 256 bytes with memcmp before comparing single elements.
+ * @param lhs The first range.
+ * @param rhs The second range.
+ * @param n The number of elements in both ranges.
+ * @return The index of the first difference, n if the ranges are equal.
+ */
+template <typename T>
+size_t MismatchIndex(const T* lhs, const T* rhs, size_t n) noexcept {
+    constexpr size_t kBlock = std::max<size_t>(1, 256 / sizeof(T));
+    size_t i = 0;
+    while (i < n) {
+        const size_t count = std::min(kBlock, n - i);
+        if (std::memcmp(lhs + i, rhs + i, count * sizeof(T)) != 0) {
+            break;
+        }
+        i += count;
+    }
+    while (i < n && lhs[i] == rhs[i]) {
+        ++i;
+    }
+    return i;
+}
+
+}  // namespace detail
 
 /**
  * @brief The RawMemory class represents a block of raw memory.
  * It provides low-level memory management for the Vector class.
+ * @tparam Alloc The allocator used to obtain the memory block, must be std::allocator_traits compatible.
  */
-template <typename T>
+template <typename T, typename Alloc = std::allocator<T>>
 class RawMemory {
+    using AllocTraits = std::allocator_traits<Alloc>;
+
+    static_assert(std::is_same_v<typename AllocTraits::value_type, T>, "Allocator value_type must be T");
+    static_assert(std::is_same_v<typename AllocTraits::pointer, T*>, "Fancy pointers are not supported");
+
     public:
-        
+        using allocator_type = Alloc;
+
+        /*< Whether TakeFrom and the sized Swap never throw, see SmallRawMemory. */
+        static constexpr bool kNothrowTransfer = true;
+
         RawMemory() = default;
 
+        /**
+         * @brief Constructs an empty memory block bound to the allocator.
+         * 
+         * @param alloc The allocator.
+         */
+        explicit RawMemory(const Alloc& alloc) noexcept : alloc_(alloc) {}
+
         /**
          * @brief Constructor.
+         * The capacity is rounded up to the granularity of the allocator, see AlignedAllocator.
          * 
          * @param capacity The capacity of the memory block.
+         * @param alloc The allocator.
          */
-        explicit RawMemory(size_t capacity) : buffer_(Allocate(capacity)), capacity_(capacity) {}
+        explicit RawMemory(size_t capacity, const Alloc& alloc = Alloc()) : alloc_(alloc), buffer_(Allocate(RoundCapacity(capacity))), capacity_(RoundCapacity(capacity)) {}
 
         ~RawMemory() { 
-            Deallocate(buffer_); 
+            Free(); 
         }
 
         RawMemory(const RawMemory&) = delete;
@@ -42,10 +527,16 @@ class RawMemory {
          * 
          * @param other The other RawMemory object to move from.
          */
-        RawMemory(RawMemory&& other) noexcept : buffer_(std::exchange(other.buffer_, nullptr)), capacity_(std::exchange(other.capacity_, 0)) {}
+        RawMemory(RawMemory&& other) noexcept 
+            : alloc_(std::move(other.alloc_))
+            , buffer_(std::exchange(other.buffer_, nullptr))
+            , capacity_(std::exchange(other.capacity_, 0))
+            , adopted_(std::exchange(other.adopted_, nullptr)) {}
 
         /**
          * @brief Move assignment operator.
+         * The allocator is transferred only if it propagates on move assignment,
+         * otherwise both allocators must compare equal.
          * 
          * @param other The other RawMemory object to move from.
          * 
@@ -54,10 +545,18 @@ class RawMemory {
         RawMemory& operator=(RawMemory&& rhs) noexcept {
 
             if (this != &rhs) {
-                buffer_ = std::move(rhs.buffer_);
-                capacity_ = std::move(rhs.capacity_);
-                rhs.buffer_ = nullptr;
-                rhs.capacity_ = 0;
+                Free();
+
+                if constexpr (AllocTraits::propagate_on_container_move_assignment::value) {
+                    alloc_ = std::move(rhs.alloc_);
+                }
+                else {
+                    assert(alloc_ == rhs.alloc_);
+                }
+
+                buffer_ = std::exchange(rhs.buffer_, nullptr);
+                capacity_ = std::exchange(rhs.capacity_, 0);
+                adopted_ = std::exchange(rhs.adopted_, nullptr);
             }
 
             return *this;
@@ -93,11 +592,130 @@ class RawMemory {
 
         /**
          * @brief Swaps the content of two RawMemory objects.
+         * The allocators are swapped only if they propagate on swap, otherwise they must compare equal.
          * @param other The other RawMemory object.
          */
         void Swap(RawMemory& other) noexcept { 
+            if constexpr (AllocTraits::propagate_on_container_swap::value) {
+                using std::swap;
+                swap(alloc_, other.alloc_);
+            }
+            else {
+                assert(alloc_ == other.alloc_);
+            }
+
             std::swap(buffer_, other.buffer_); 
             std::swap(capacity_, other.capacity_); 
+            std::swap(adopted_, other.adopted_); 
+        }
+
+        /**
+         * @brief Swaps the content of two memory blocks holding live elements.
+         * Heap blocks are swapped as a whole, the element counts matter only to storages with an inline buffer.
+         * @param other The other RawMemory object.
+         */
+        void Swap(RawMemory& other, size_t /*size*/, size_t /*other_size*/) noexcept { 
+            Swap(other);
+        }
+
+        /**
+         * @brief Takes over the memory block of another object, releasing the own one.
+         * The own block must not hold live elements. Follows the move assignment allocator rules.
+         * @param other The other RawMemory object, left empty.
+         */
+        void TakeFrom(RawMemory& other, size_t /*size*/) noexcept { 
+            *this = std::move(other);
+        }
+
+        /**
+         * @brief Resizes the memory block through the allocator reallocate(), keeping its bytes.
+         * The block may be extended in place. Usable only with elements that are relocated bitwise.
+         * @param new_capacity The new capacity of the memory block, at least size.
+         * @param size The number of live elements at the start of the block.
+         */
+        void Reallocate(size_t new_capacity, size_t size) requires detail::kHasReallocate<Alloc, T> {
+            assert(size <= new_capacity && size <= capacity_);
+            if (adopted_ != nullptr) {
+                // The allocator can not resize a block it did not allocate
+                RawMemory block(new_capacity, alloc_);
+                std::memcpy(static_cast<void*>(block.buffer_), static_cast<const void*>(buffer_), size * sizeof(T));
+                detail::RecordRelocation<T>(size);
+                Swap(block);
+                return;
+            }
+
+            new_capacity = RoundCapacity(new_capacity);
+            buffer_ = alloc_.reallocate(buffer_, capacity_, new_capacity);
+            if (capacity_ == 0) {
+                detail::RecordAllocation<T>(new_capacity);
+            }
+            else {
+                detail::RecordRelocation<T>(size);
+                detail::RecordCapacity<T>(new_capacity);
+            }
+            capacity_ = new_capacity;
+        }
+
+        /**
+         * @brief Releases the memory block and rebinds the object to another allocator.
+         * @param alloc The new allocator.
+         */
+        void Reset(const Alloc& alloc) noexcept {
+            Free();
+            buffer_ = nullptr;
+            capacity_ = 0;
+            adopted_ = nullptr;
+            alloc_ = alloc;
+        }
+
+        /**
+         * @brief Takes ownership of a memory block allocated with an allocator equal to the own one, releasing the own block.
+         * The own block must not hold live elements.
+         * @param buffer The memory block.
+         * @param capacity The number of elements the block was allocated for.
+         */
+        void Adopt(T* buffer, size_t capacity) noexcept {
+            Free();
+            buffer_ = buffer;
+            capacity_ = capacity;
+            adopted_ = nullptr;
+        }
+
+        /**
+         * @brief Takes ownership of a memory block obtained elsewhere, releasing the own block.
+         * The own block must not hold live elements. If an exception is thrown, nothing changes
+         * and the block stays with the caller.
+         * @param buffer The memory block.
+         * @param capacity The number of elements the block has room for.
+         * @param deleter Called with buffer to release the block, must not throw.
+         */
+        template <typename Deleter>
+        void Adopt(T* buffer, size_t capacity, Deleter deleter) {
+            detail::AdoptedBlock<T>* adopted = new detail::AdoptedBlockWith<T, Deleter>(std::move(deleter));
+            Free();
+            buffer_ = buffer;
+            capacity_ = capacity;
+            adopted_ = adopted;
+        }
+
+        /**
+         * @brief Gives up the memory block without releasing it, leaving the object empty.
+         * The deleter of an adopted block is discarded.
+         * @return The memory block.
+         */
+        T* Release() noexcept {
+            delete adopted_;
+            adopted_ = nullptr;
+            capacity_ = 0;
+            return std::exchange(buffer_, nullptr);
+        }
+
+        /**
+         * @brief Tells whether the memory block was adopted with a deleter rather than obtained from the allocator.
+         * @return True if the block is released by a deleter.
+         */
+        bool IsAdopted() const noexcept {
+            return adopted_ != nullptr;
         }
 
         /**
@@ -120,65 +738,338 @@ class RawMemory {
             return capacity_; 
         }
 
+        /**
+         * @brief Gets the allocator of the memory block.
+         * @return A reference to the allocator.
+         */
+        const Alloc& GetAllocator() const noexcept { 
+            return alloc_; 
+        }
+
+        Alloc& GetAllocator() noexcept { 
+            return alloc_; 
+        }
+
     private:
+        [[no_unique_address]] Alloc alloc_; /*< The allocator of the memory block. */
         T* buffer_ = nullptr;   /*< The pointer to the memory block. */
         size_t capacity_ = 0;   /*< The capacity of the memory block. */
+        detail::AdoptedBlock<T>* adopted_ = nullptr; /*< The deleter of an adopted block, nullptr for blocks of the allocator. */
+
+        /**
+         * @brief Releases the memory block through its deleter or the allocator.
+         */
+        void Free() noexcept {
+            if (adopted_ != nullptr) {
+                adopted_->Release(buffer_);
+                delete adopted_;
+            }
+            else {
+                Deallocate(buffer_, capacity_);
+            }
+        }
+
+        /**
+         * @brief Rounds a capacity up to a multiple of the allocator capacity_granularity, if it declares one,
+         * or to the capacity the allocator round_capacity(n) reports as free of charge, see PoolAllocator.
+         * @param n The number of elements.
+         * @return The rounded number of elements.
+         */
+        static constexpr size_t RoundCapacity(size_t n) noexcept {
+            if constexpr (requires { Alloc::round_capacity(n); }) {
+                return Alloc::round_capacity(n);
+            }
+            else if constexpr (requires { Alloc::capacity_granularity; }) {
+                return (n + Alloc::capacity_granularity - 1) / Alloc::capacity_granularity * Alloc::capacity_granularity;
+            }
+            else {
+                return n;
+            }
+        }
 
         /**
          * @brief Allocates memory for the specified number of elements.
          * @param n The number of elements.
          * @return A pointer to the allocated memory block.
          */
-        static T* Allocate(size_t n) { 
-            return n != 0 ? static_cast<T*>(operator new(n * sizeof(T))) : nullptr; 
+        T* Allocate(size_t n) { 
+            if (n == 0) {
+                return nullptr;
+            }
+            T* buf = AllocTraits::allocate(alloc_, n);
+            detail::RecordAllocation<T>(n);
+            return buf;
         }
         
         /**
          * @brief Deallocates the memory block.
          * @param buf The pointer to the memory block to deallocate.
+         * @param n The number of elements the block was allocated for.
          */
-        static void Deallocate(T* buf) noexcept { 
-            operator delete(buf); 
+        void Deallocate(T* buf, size_t n) noexcept { 
+            if (buf != nullptr) {
+                AllocTraits::deallocate(alloc_, buf, n); 
+                detail::RecordDeallocation<T>();
+            }
         }
 };
 
 /**
- * @brief The Vector class implements a dynamically resizable array.
+ * @brief Tag selecting default-initialization of new elements, which leaves trivial types such as char unset.
+ */
+struct DefaultInitTag {
+    explicit DefaultInitTag() = default;
+};
+
+inline constexpr DefaultInitTag DefaultInit{};
+
+/**
+ * @brief A buffer handed back by Vector::Release, the caller owns its elements and its memory.
  */
 template <typename T>
+struct ReleasedBuffer {
+    T* data = nullptr;      /*< The memory block. */
+    size_t size = 0;        /*< The number of live elements at the start of the block. */
+    size_t capacity = 0;    /*< The number of elements the block has room for. */
+};
+
+/**
+ * @brief Growth policy that doubles the capacity.
+ * A growth policy provides NextCapacity(capacity, required, element_size) returning
+ * the capacity to grow to, which must be at least required.
+ * @tparam MinCapacity The capacity of the first allocation.
+ */
+template <size_t MinCapacity = 1>
+struct DoublingGrowth {
+    static constexpr size_t NextCapacity(size_t capacity, size_t required, size_t /*element_size*/) noexcept {
+        return std::max({MinCapacity, capacity * 2, required});
+    }
+};
+
+/**
+ * @brief Growth policy that multiplies the capacity by Numerator / Denominator, 1.5 by default.
+ * Factors below 2 let the allocator reuse the blocks freed by the previous reallocations.
+ * @tparam MinCapacity The capacity of the first allocation.
+ */
+template <size_t Numerator = 3, size_t Denominator = 2, size_t MinCapacity = 4>
+struct GeometricGrowth {
+    static_assert(Numerator > Denominator, "The growth factor must be greater than 1");
+
+    static constexpr size_t NextCapacity(size_t capacity, size_t required, size_t /*element_size*/) noexcept {
+        return std::max({MinCapacity, capacity / Denominator * Numerator + capacity % Denominator * Numerator / Denominator, required});
+    }
+};
+
+/**
+ * @brief Growth policy that rounds the capacity of another policy up to whole pages.
+ * @tparam Base The policy computing the capacity before rounding.
+ * @tparam PageSize The page size in bytes.
+ */
+template <typename Base = DoublingGrowth<>, size_t PageSize = 4096>
+struct PageRoundedGrowth {
+    static constexpr size_t NextCapacity(size_t capacity, size_t required, size_t element_size) noexcept {
+        const size_t bytes = Base::NextCapacity(capacity, required, element_size) * element_size;
+        return (bytes + PageSize - 1) / PageSize * PageSize / element_size;
+    }
+};
+
+/**
+ * @brief Growth policy that rounds the capacity of another policy up to the jemalloc size classes,
+ * so the slack the allocator would waste becomes usable capacity.
+ * Classes are multiples of 8 up to 16 bytes and four per power of two above, spaced at least 16 bytes apart.
+ * @tparam Base The policy computing the capacity before rounding.
+ */
+template <typename Base = DoublingGrowth<>>
+struct SizeClassGrowth {
+    static constexpr size_t NextCapacity(size_t capacity, size_t required, size_t element_size) noexcept {
+        const size_t bytes = Base::NextCapacity(capacity, required, element_size) * element_size;
+        return std::max(RoundToSizeClass(bytes) / element_size, required);
+    }
+
+    static constexpr size_t RoundToSizeClass(size_t bytes) noexcept {
+        if (bytes <= 16) {
+            return (bytes + 7) / 8 * 8;
+        }
+
+        size_t lg = 0;
+        for (size_t rest = bytes - 1; rest > 1; rest >>= 1) {
+            ++lg;
+        }
+
+        const size_t spacing = std::max<size_t>(16, size_t{1} << (lg - 2));
+        return (bytes + spacing - 1) / spacing * spacing;
+    }
+};
+
+/**
+ * @brief Growth policy that also gives memory back: while the size is below capacity / Divisor
+ * after an erasure, the capacity is halved. The gap between the thresholds keeps alternating
+ * insertions and erasures from reallocating every time.
+ * A growth policy may provide ShrinkCapacity(capacity, size, element_size) returning the capacity
+ * to shrink to, or capacity to keep the storage.
+ * @tparam Base The policy computing the capacity when growing.
+ * @tparam Divisor The fraction of the capacity below which the storage shrinks.
+ */
+template <typename Base = DoublingGrowth<>, size_t Divisor = 4>
+struct ShrinkingGrowth {
+    static_assert(Divisor > 2, "Shrinking by half needs a threshold below half of the capacity");
+
+    static constexpr size_t NextCapacity(size_t capacity, size_t required, size_t element_size) noexcept {
+        return Base::NextCapacity(capacity, required, element_size);
+    }
+
+    static constexpr size_t ShrinkCapacity(size_t capacity, size_t size, size_t /*element_size*/) noexcept {
+        while (size < capacity / Divisor) {
+            capacity /= 2;
+        }
+        return capacity;
+    }
+};
+
+/**
+ * @brief The Vector class implements a dynamically resizable array.
+ * @tparam Alloc The allocator used for the storage and for constructing the elements.
+ * Copy, move and swap follow the std::allocator_traits propagation rules.
+ * @tparam Growth The growth policy applied whenever an insertion or Resize runs out of capacity.
+ * Reserve allocates at least the requested capacity, rounded to the allocator's granularity. Policies such as
+ * ShrinkingGrowth also release memory after PopBack, Erase and shrinking Resize.
+ * @tparam Storage The memory block holding the elements: RawMemory, or SmallRawMemory for an inline buffer.
+ * Grown storage is a fresh RawMemory swapped into place, or the same block resized through the allocator
+ * reallocate() for elements that are relocated bitwise.
+ */
+template <typename T, typename Alloc = std::allocator<T>, typename Growth = DoublingGrowth<>, typename Storage = RawMemory<T, Alloc>>
 class Vector {
+    using AllocTraits = std::allocator_traits<Alloc>;
+
     public:
 
         using iterator = T*; /*< Iterator type for iterating over the elements of the Vector. */
         using const_iterator = const T*; /*< Const iterator type for iterating over the elements of the Vector. */
+        using allocator_type = Alloc; /*< Allocator type of the Vector. */
 
 
         Vector() = default;
 
+        /**
+         * @brief Constructs an empty Vector using the allocator.
+         * @param alloc The allocator.
+         */
+        explicit Vector(const Alloc& alloc) noexcept : data_(alloc) {}
+
         /**
          * @brief Constructor.
          * @param size The initial size of the Vector.
+         * @param alloc The allocator.
          */
-        explicit Vector(size_t size) : data_(size), size_(size) {
-            std::uninitialized_value_construct_n(data_.GetAddress(), size);
+        explicit Vector(size_t size, const Alloc& alloc = Alloc()) : data_(size, alloc), size_(size) {
+            detail::UninitializedValueConstructN(data_.GetAllocator(), data_.GetAddress(), size);
+        }
+
+        /**
+         * @brief Constructs a Vector of value-initialized elements, constructing them on several threads.
+         * @param policy The parallel policy.
+         * @param size The initial size of the Vector.
+         * @param alloc The allocator.
+         */
+        Vector(ParallelTag policy, size_t size, const Alloc& alloc = Alloc()) : data_(size, alloc), size_(size) {
+            detail::ParallelUninitializedValueConstructN(policy, data_.GetAllocator(), data_.GetAddress(), size);
+        }
+
+        /**
+         * @brief Constructs a Vector of default-initialized elements.
+         * Trivial elements are left unset instead of being zero-filled.
+         * @param size The initial size of the Vector.
+         * @param alloc The allocator.
+         */
+        Vector(size_t size, DefaultInitTag, const Alloc& alloc = Alloc()) : data_(size, alloc), size_(size) {
+            detail::UninitializedDefaultConstructN(data_.GetAllocator(), data_.GetAddress(), size);
+        }
+
+        /**
+         * @brief Constructs a Vector with the elements of a range.
+         * For forward iterators the storage is allocated once with the exact capacity.
+         * @param first The iterator to the first element of the range.
+         * @param last The iterator past the last element of the range.
+         * @param alloc The allocator.
+         */
+        template <std::input_iterator InputIt>
+        Vector(InputIt first, InputIt last, const Alloc& alloc = Alloc()) : data_(alloc) {
+            if constexpr (detail::MultiPassIterator<InputIt>) {
+                const size_t count = std::distance(first, last);
+                Reserve(count);
+                detail::UninitializedCopyN(data_.GetAllocator(), first, count, data_.GetAddress());
+                size_ = count;
+            }
+            else {
+                Append(first, last);
+            }
         }
 
         /**
          * @brief Copy constructor.
+         * The allocator is obtained by select_on_container_copy_construction.
+         * @param other The other Vector object to copy from.
+         */
+        Vector(const Vector& other) : Vector(other, AllocTraits::select_on_container_copy_construction(other.data_.GetAllocator())) {}
+
+        /**
+         * @brief Copy constructor with an explicit allocator.
+         * @param other The other Vector object to copy from.
+         * @param alloc The allocator of the new Vector.
+         */
+        Vector(const Vector& other, const Alloc& alloc) : data_(other.size_, alloc), size_(other.size_) {
+            detail::UninitializedCopyN(data_.GetAllocator(), other.data_.GetAddress(), size_, data_.GetAddress());
+        }
+
+        /**
+         * @brief Copy constructor copying the elements on several threads.
+         * The allocator is obtained by select_on_container_copy_construction.
+         * @param policy The parallel policy.
+         * @param other The other Vector object to copy from.
+         */
+        Vector(ParallelTag policy, const Vector& other)
+            : Vector(policy, other, AllocTraits::select_on_container_copy_construction(other.data_.GetAllocator())) {}
+
+        /**
+         * @brief Copy constructor with an explicit allocator copying the elements on several threads.
+         * @param policy The parallel policy.
          * @param other The other Vector object to copy from.
+         * @param alloc The allocator of the new Vector.
          */
-        Vector(const Vector& other) : data_(other.size_), size_(other.size_) {
-            std::uninitialized_copy_n(other.data_.GetAddress(), size_, data_.GetAddress());
+        Vector(ParallelTag policy, const Vector& other, const Alloc& alloc) : data_(other.size_, alloc), size_(other.size_) {
+            detail::ParallelUninitializedCopyN(policy, data_.GetAllocator(), other.data_.GetAddress(), size_, data_.GetAddress());
         }
 
         /**
          * @brief Move constructor.
          * @param other The other Vector object to move from.
          */
-        Vector(Vector&& other) noexcept : data_(std::move(other.data_)), size_(std::exchange(other.size_, 0)) {}
+        Vector(Vector&& other) noexcept(Storage::kNothrowTransfer) : data_(other.data_.GetAllocator()) {
+            data_.TakeFrom(other.data_, other.size_);
+            size_ = std::exchange(other.size_, 0);
+        }
+
+        /**
+         * @brief Move constructor with an explicit allocator.
+         * The buffer is stolen if the allocators compare equal, otherwise the elements are moved one by one.
+         * @param other The other Vector object to move from.
+         * @param alloc The allocator of the new Vector.
+         */
+        Vector(Vector&& other, const Alloc& alloc) : data_(alloc) {
+            if (data_.GetAllocator() == other.data_.GetAllocator()) {
+                data_.TakeFrom(other.data_, other.size_);
+                size_ = std::exchange(other.size_, 0);
+            }
+            else {
+                Reserve(other.size_);
+                detail::UninitializedCopyN(data_.GetAllocator(), std::make_move_iterator(other.begin()), other.size_, data_.GetAddress());
+                size_ = other.size_;
+            }
+        }
 
         ~Vector() { 
-            std::destroy_n(data_.GetAddress(), size_); 
+            detail::RecordRetirement<T>(data_.Capacity(), size_);
+            detail::DestroyN(data_.GetAllocator(), data_.GetAddress(), size_); 
         }
 
         iterator begin() noexcept { 
@@ -214,26 +1105,43 @@ class Vector {
             return data_.Capacity(); 
         }
 
+        /**
+         * @brief Gets a copy of the allocator of the Vector.
+         * @return The allocator.
+         */
+        allocator_type GetAllocator() const noexcept { 
+            return data_.GetAllocator(); 
+        }
+
         /**
          * @brief Reserves capacity for the Vector.
          * @param new_capacity The new capacity to reserve.
          */
         void Reserve(size_t new_capacity) {
+            Reserve(detail::kSingleThread, new_capacity);
+        }
+
+        /**
+         * @brief Reserves capacity for the Vector, relocating the elements on several threads.
+         * @param policy The parallel policy.
+         * @param new_capacity The new capacity to reserve.
+         */
+        void Reserve(ParallelTag policy, size_t new_capacity) {
 
             if (new_capacity <= data_.Capacity()) {
                 return;
             }
 
-            RawMemory<T> new_data(new_capacity);
-
-            if constexpr (std::is_nothrow_move_constructible_v<T> || !std::is_copy_constructible_v<T>) {
-                std::uninitialized_move_n(data_.GetAddress(), size_, new_data.GetAddress());
-            }
-            else {
-                std::uninitialized_copy_n(data_.GetAddress(), size_, new_data.GetAddress());
+            if constexpr (kGrowsInPlace) {
+                data_.Reallocate(new_capacity, size_);
+                return;
             }
 
-            std::destroy_n(data_.GetAddress(), size_);
+            RawMemory<T, Alloc> new_data(new_capacity, data_.GetAllocator());
+
+            detail::ParallelUninitializedRelocateN(policy, data_.GetAllocator(), data_.GetAddress(), size_, new_data.GetAddress());
+            detail::RecordRelocation<T>(size_);
+
             data_.Swap(new_data);
         }
 
@@ -244,29 +1152,168 @@ class Vector {
         void Resize(size_t new_size) {
 
             if (new_size < size_) {
-                std::destroy_n(data_.GetAddress() + new_size, size_ - new_size);
+                detail::DestroyN(data_.GetAllocator(), data_.GetAddress() + new_size, size_ - new_size);
+                size_ = new_size;
+                ShrinkByPolicy();
+            }
+            else {
+                EnsureCapacity(new_size);
+                detail::UninitializedValueConstructN(data_.GetAllocator(), data_.GetAddress() + size_, new_size - size_);
+                size_ = new_size;
+            }
+        }
+
+        /**
+         * @brief Resizes the Vector, default-initializing the new elements.
+         * Trivial elements are left unset, for buffers that are overwritten right away.
+         * @param new_size The new size of the Vector.
+         */
+        void ResizeDefaultInit(size_t new_size) {
 
+            if (new_size < size_) {
+                detail::DestroyN(data_.GetAllocator(), data_.GetAddress() + new_size, size_ - new_size);
+                size_ = new_size;
+                ShrinkByPolicy();
             }
             else {
+                EnsureCapacity(new_size);
+                detail::UninitializedDefaultConstructN(data_.GetAllocator(), data_.GetAddress() + size_, new_size - size_);
+                size_ = new_size;
+            }
+        }
+
+        /**
+         * @brief Reduces the capacity to the size of the Vector, releasing the unused memory.
+         */
+        void ShrinkToFit() {
+            ShrinkTo(size_);
+        }
+
+        /**
+         * @brief Reduces the capacity to new_capacity, but not below the size of the Vector.
+         * Does nothing if the capacity is already smaller. A SmallVector moves back to its inline
+         * buffer when the elements fit. Gives the strong guarantee.
+         * @param new_capacity The new capacity.
+         */
+        void ShrinkTo(size_t new_capacity) {
+            new_capacity = std::max(new_capacity, size_);
+            if (new_capacity >= data_.Capacity()) {
+                return;
+            }
 
-                if (new_size > data_.Capacity()) {
-                    const size_t new_capacity = std::max(data_.Capacity() * 2, new_size);
+            if (new_capacity == 0) {
+                Storage empty(data_.GetAllocator());
+                data_.Swap(empty, 0, 0);
+                return;
+            }
 
-                    Reserve(new_capacity);
+            if constexpr (kGrowsInPlace) {
+                if (new_capacity > detail::kInlineCapacity<Storage>) {
+                    data_.Reallocate(new_capacity, size_);
+                    return;
                 }
+            }
 
-                std::uninitialized_value_construct_n(data_.GetAddress() + size_, new_size - size_);
+            Storage new_data(new_capacity, data_.GetAllocator());
+            if (new_data.Capacity() >= data_.Capacity()) {
+                return;
+            }
+
+            detail::UninitializedRelocateN(data_.GetAllocator(), data_.GetAddress(), size_, new_data.GetAddress());
+            detail::RecordRelocation<T>(size_);
+            data_.Swap(new_data, 0, size_);
+        }
+
+        /**
+         * @brief Resizes the Vector to at most count elements filled by an operation, in the spirit of
+         * std::basic_string::resize_and_overwrite.
+         * The elements past the current size are default-initialized, then op(data, count) writes the buffer
+         * and returns the final size, which must not exceed count. Elements past the final size are destroyed.
+         * If op throws, the size is left unchanged.
+         * @param count The number of elements op may write.
+         * @param op The operation, called as op(T* data, size_t count) -> size_t.
+         */
+        template <typename Operation>
+        void ResizeAndOverwrite(size_t count, Operation op) {
+            const size_t old_size = size_;
+            if (count > size_) {
+                EnsureCapacity(count);
+                detail::UninitializedDefaultConstructN(data_.GetAllocator(), data_.GetAddress() + size_, count - size_);
+                size_ = count;
             }
 
-            size_ = new_size;
+            size_t new_size = 0;
+            try {
+                new_size = std::move(op)(data_.GetAddress(), count);
+            }
+            catch (...) {
+                Resize(old_size);
+                throw;
+            }
+
+            assert(new_size <= count);
+            Resize(new_size);
         }
 
         /**
          * @brief Swaps the content of two Vector objects.
          * @param other The other Vector object.
          */
-        void Swap(Vector& other) noexcept { 
-            data_.Swap(other.data_), std::swap(size_, other.size_); 
+        void Swap(Vector& other) noexcept(Storage::kNothrowTransfer) { 
+            data_.Swap(other.data_, size_, other.size_);
+            std::swap(size_, other.size_); 
+        }
+
+        /**
+         * @brief Takes ownership of a buffer allocated with an allocator equal to GetAllocator(), replacing the content.
+         * The buffer must hold size live elements and have room for capacity elements.
+         * @param data The buffer.
+         * @param size The number of live elements.
+         * @param capacity The number of elements the buffer was allocated for.
+         */
+        void Adopt(T* data, size_t size, size_t capacity) noexcept {
+            assert(size <= capacity);
+            RawMemory<T, Alloc> block(data_.GetAllocator());
+            block.Adopt(data, capacity);
+            AdoptBlock(block, size);
+        }
+
+        /**
+         * @brief Takes ownership of a buffer obtained elsewhere, replacing the content, without copying the elements.
+         * The buffer must hold size live elements and have room for capacity elements. The Vector destroys
+         * the elements and calls deleter(data) once it no longer needs the buffer, after growing beyond it at the latest.
+         * Gives the strong guarantee, if an exception is thrown the buffer stays with the caller.
+         * @param data The buffer.
+         * @param size The number of live elements.
+         * @param capacity The number of elements the buffer has room for.
+         * @param deleter Releases the buffer, must not throw.
+         */
+        template <typename Deleter>
+            requires std::invocable<Deleter&, T*>
+        void Adopt(T* data, size_t size, size_t capacity, Deleter deleter) {
+            assert(size <= capacity);
+            RawMemory<T, Alloc> block(data_.GetAllocator());
+            block.Adopt(data, capacity, std::move(deleter));
+            AdoptBlock(block, size);
+        }
+
+        /**
+         * @brief Hands the buffer and its elements over to the caller, leaving the Vector empty.
+         * The caller destroys the elements and releases the buffer: with the deleter it was adopted with if
+         * IsAdopted() was true, with GetAllocator().deallocate(data, capacity) otherwise.
+         * @return The buffer.
+         */
+        ReleasedBuffer<T> Release() noexcept requires std::same_as<Storage, RawMemory<T, Alloc>> {
+            const size_t capacity = data_.Capacity();
+            return {data_.Release(), std::exchange(size_, 0), capacity};
+        }
+
+        /**
+         * @brief Tells whether the buffer was adopted with a deleter.
+         * @return True if the buffer will be released by a deleter passed to Adopt.
+         */
+        bool IsAdopted() const noexcept {
+            return data_.IsAdopted();
         }
 
         /**
@@ -289,18 +1336,50 @@ class Vector {
         iterator Emplace(const_iterator pos, Args&&... args);
 
         /**
-         * @brief Erases an element at the specified position from the Vector.
-         * @param pos The position of the element to erase.
-         * @return An iterator pointing to the element following the erased element.
+         * @brief Erases an element at the specified position from the Vector.
+         * @param pos The position of the element to erase.
+         * @return An iterator pointing to the element following the erased element.
+         */
+        iterator Erase(const_iterator pos) {
+
+            assert(pos >= begin() && pos < end());
+            return Erase(pos, pos + 1);
+        }
+
+        /**
+         * @brief Erases the elements in the range [first, last) from the Vector.
+         * The tail is shifted once, bitwise relocatable elements are shifted with memmove.
+         * @param first The position of the first element to erase.
+         * @param last The position past the last element to erase.
+         * @return An iterator pointing to the element following the erased elements.
+         */
+        iterator Erase(const_iterator first, const_iterator last) {
+
+            assert(first >= begin() && first <= last && last <= end());
+            const size_t indx = first - begin();
+            const size_t count = last - first;
+            T* pos = begin() + indx;
+
+            if constexpr (detail::kRelocatesBitwise<Alloc, T>) {
+                detail::DestroyN(data_.GetAllocator(), pos, count);
+                std::memmove(static_cast<void*>(pos), static_cast<const void*>(pos + count), (size_ - indx - count) * sizeof(T));
+            }
+            else {
+                std::move(pos + count, end(), pos);
+                detail::DestroyN(data_.GetAllocator(), end() - count, count);
+            }
+
+            size_ -= count;
+            ShrinkByPolicy();
+            return begin() + indx;
+        }
+
+        /**
+         * @brief Destroys all elements of the Vector, the capacity is kept.
          */
-        iterator Erase(const_iterator pos) {
-
-            assert(pos >= begin() && pos < end());
-            size_t indx = pos - begin();
-            std::move(begin() + indx + 1, end(), begin() + indx);
-            std::destroy_at(end() - 1);
-            size_ -= 1;
-            return (begin() + indx);
+        void Clear() noexcept {
+            detail::DestroyN(data_.GetAllocator(), data_.GetAddress(), size_);
+            size_ = 0;
         }
 
         /**
@@ -323,13 +1402,127 @@ class Vector {
             return Emplace(pos, std::move(item)); 
         }
 
+        /**
+         * @brief Inserts count copies of a value at the specified position in the Vector.
+         * Reallocates at most once and shifts the tail once. The value may refer to an element of the Vector.
+         * @param pos The position at which to insert the elements.
+         * @param count The number of copies.
+         * @param item The item to insert.
+         * @return An iterator pointing to the first inserted element.
+         */
+        iterator Insert(const_iterator pos, size_t count, const T& item) { 
+            assert(pos >= begin() && pos <= end());
+            const size_t indx = pos - begin();
+
+            if (count == 0) {
+                return begin() + indx;
+            }
+
+            const T copy(item);
+            return InsertRange(indx, detail::RepeatIterator<T>(copy), count);
+        }
+
+        /**
+         * @brief Inserts the elements of a range at the specified position in the Vector.
+         * For forward iterators the final size is computed once: the Vector reallocates at most once
+         * and the tail is shifted once. Input iterators are appended one by one and rotated into place.
+         * The range must not refer to the elements of the Vector.
+         * @param pos The position at which to insert the elements.
+         * @param first The iterator to the first element of the range.
+         * @param last The iterator past the last element of the range.
+         * @return An iterator pointing to the first inserted element.
+         */
+        template <std::input_iterator InputIt>
+        iterator Insert(const_iterator pos, InputIt first, InputIt last) { 
+            assert(pos >= begin() && pos <= end());
+            const size_t indx = pos - begin();
+
+            if constexpr (detail::MultiPassIterator<InputIt>) {
+                const size_t count = std::distance(first, last);
+                return count != 0 ? InsertRange(indx, first, count) : begin() + indx;
+            }
+            else {
+                const size_t old_size = size_;
+                for (; first != last; ++first) {
+                    EmplaceBack(*first);
+                }
+                std::rotate(begin() + indx, begin() + old_size, end());
+                return begin() + indx;
+            }
+        }
+
+        /**
+         * @brief Appends the elements of a range to the end of the Vector.
+         * For forward iterators the Vector reallocates at most once.
+         * @param first The iterator to the first element of the range.
+         * @param last The iterator past the last element of the range.
+         */
+        template <std::input_iterator InputIt>
+        void Append(InputIt first, InputIt last) { 
+            Insert(cend(), first, last);
+        }
+
+        /**
+         * @brief Inserts the elements of a sorted range into the sorted Vector, keeping it sorted.
+         * The elements are merged from the back in one pass, so every element moves at most once and
+         * the Vector reallocates at most once: O(n + k) moves and O(k log n) comparisons instead of
+         * the O(k * n) moves of k calls to Insert. New elements go after the equal elements already present.
+         * The range must not refer to the elements of the Vector.
+         * All comparisons are made before any element moves, so a throwing comparator leaves the Vector unchanged.
+         * Gives the strong guarantee if the elements move without throwing, the basic one otherwise.
+         * A range whose elements can throw while being copied in is first copied to a temporary Vector.
+         * @param first The iterator to the first element of the range.
+         * @param last The iterator past the last element of the range.
+         * @param comp The ordering of both the Vector and the range.
+         */
+        template <std::input_iterator InputIt, typename Compare = std::less<>>
+        void MergeInsert(InputIt first, InputIt last, Compare comp = {}) {
+            using Reference = std::iter_reference_t<InputIt>;
+            if constexpr (!detail::BidirectionalIterator<InputIt>
+                          || (!std::is_nothrow_constructible_v<T, Reference> && std::is_nothrow_move_constructible_v<T>)) {
+                Vector staged(first, last, data_.GetAllocator());
+                MergeInsert(std::make_move_iterator(staged.begin()), std::make_move_iterator(staged.end()), comp);
+            }
+            else {
+                assert(std::is_sorted(begin(), end(), comp) && std::is_sorted(first, last, comp));
+                const size_t count = std::distance(first, last);
+                if (count == 0) {
+                    return;
+                }
+                const MergePositions positions = FindMergePositions(first, count, comp);
+                if (size_ + count > data_.Capacity()) {
+                    if constexpr (kGrowsInPlace) {
+                        data_.Reallocate(NextCapacity(size_ + count), size_);
+                    }
+                    else {
+                        MergeIntoNewBlock(first, count, positions);
+                        return;
+                    }
+                }
+                MergeInPlace(last, count, positions);
+            }
+        }
+
+        /**
+         * @brief Inserts an element into the sorted Vector after the elements equal to it.
+         * @param value The value to insert.
+         * @param comp The ordering of the Vector.
+         * @return An iterator pointing to the inserted element.
+         */
+        template <typename Type, typename Compare = std::less<>>
+        iterator InsertSorted(Type&& value, Compare comp = {}) {
+            const T* pos = std::upper_bound(cbegin(), cend(), value, comp);
+            return Emplace(pos, std::forward<Type>(value));
+        }
+
         /**
          * @brief Removes the last element from the Vector.
          */
         void PopBack() {
             assert(size_);
-            std::destroy_at(data_.GetAddress() + size_ - 1);
+            detail::DestroyAt(data_.GetAllocator(), data_.GetAddress() + size_ - 1);
             --size_;
+            ShrinkByPolicy();
         }
 
         /**
@@ -342,35 +1535,31 @@ class Vector {
 
         /**
          * @brief Copy assignment operator.
+         * The allocator is replaced only if it propagates on copy assignment.
          * @param other The other Vector object to copy from.
          * @return A reference to the current Vector object.
          */
         Vector& operator=(const Vector& other) {
-            if (this != &other) {
-                if (other.size_ <= data_.Capacity()) {
-                    if (size_ <= other.size_) {
-                        std::copy(other.data_.GetAddress(),
-                            other.data_.GetAddress() + size_,
-                            data_.GetAddress());
-
-                        std::uninitialized_copy_n(other.data_.GetAddress() + size_,
-                            other.size_ - size_,
-                            data_.GetAddress() + size_);
-                    }
-                    else {
+            return Assign(detail::kSingleThread, other);
+        }
 
-                        std::copy(other.data_.GetAddress(),
-                            other.data_.GetAddress() + other.size_,
-                            data_.GetAddress());
-                        std::destroy_n(data_.GetAddress() + other.size_,
-                            size_ - other.size_);
+        /**
+         * @brief Copy assignment copying the elements on several threads.
+         * @param policy The parallel policy.
+         * @param other The other Vector object to copy from.
+         * @return A reference to the current Vector object.
+         */
+        Vector& Assign(ParallelTag policy, const Vector& other) {
+            if (this != &other) {
+                if constexpr (AllocTraits::propagate_on_container_copy_assignment::value) {
+                    if (data_.GetAllocator() != other.data_.GetAllocator()) {
+                        detail::DestroyN(data_.GetAllocator(), data_.GetAddress(), size_);
+                        size_ = 0;
+                        data_.Reset(other.data_.GetAllocator());
                     }
-                    size_ = other.size_;
-                }
-                else {
-                    Vector other_copy(other);
-                    Swap(other_copy);
                 }
+
+                AssignFrom(other.data_.GetAddress(), other.size_, policy);
             }
 
             return *this;
@@ -385,46 +1574,438 @@ class Vector {
             return data_[index]; 
         }
 
-        Vector& operator=(Vector&& other) noexcept { 
-            Swap(other); 
+        /**
+         * @brief Move assignment operator.
+         * Takes over the buffer in O(1) if the allocator propagates on move assignment or the allocators
+         * compare equal, otherwise moves the elements one by one into the own storage.
+         * @param other The other Vector object to move from.
+         * @return A reference to the current Vector object.
+         */
+        Vector& operator=(Vector&& other) noexcept(Storage::kNothrowTransfer
+            && (AllocTraits::propagate_on_container_move_assignment::value || AllocTraits::is_always_equal::value)) { 
+
+            if (this != &other) {
+                if constexpr (AllocTraits::propagate_on_container_move_assignment::value || AllocTraits::is_always_equal::value) {
+                    StealFrom(other);
+                }
+                else {
+                    if (data_.GetAllocator() == other.data_.GetAllocator()) {
+                        StealFrom(other);
+                    }
+                    else {
+                        AssignFrom(std::make_move_iterator(other.data_.GetAddress()), other.size_);
+                    }
+                }
+            }
+
             return *this; 
         }
 
     private:
-        RawMemory<T> data_; /*< The RawMemory object for storing the elements. */
+        /*< Whether the storage grows through the allocator reallocate() instead of a fresh block. */
+        static constexpr bool kGrowsInPlace = detail::kRelocatesBitwise<Alloc, T>
+            && requires(Storage& storage, size_t capacity) { storage.Reallocate(capacity, capacity); };
+
+        Storage data_; /*< The memory block for storing the elements. */
         size_t size_ = 0; /*< The size of the Vector. */
-};
 
-/**
- * @brief Pushes a new element to the end of the Vector.
- * @tparam Type The type of the element to push.
- * @param value The value of the element to push.
- */
-template <typename T>
-template <typename Type>
-void Vector<T>::PushBack(Type&& value) {
+        /**
+         * @brief Grows the storage with the growth policy if it can not hold the required number of elements.
+         * @param required The number of elements to hold.
+         */
+        void EnsureCapacity(size_t required) {
+            if (required > data_.Capacity()) {
+                Reserve(NextCapacity(required));
+            }
+        }
 
-    if (data_.Capacity() <= size_) {
+        /**
+         * @brief Shrinks the storage if the growth policy asks for it.
+         * A shrink that fails keeps the current storage, so erasing never throws because of it.
+         */
+        void ShrinkByPolicy() noexcept {
+            if constexpr (requires { Growth::ShrinkCapacity(size_t{}, size_t{}, size_t{}); }) {
+                const size_t new_capacity = Growth::ShrinkCapacity(data_.Capacity(), size_, sizeof(T));
+                if (new_capacity < data_.Capacity()) {
+                    try {
+                        ShrinkTo(new_capacity);
+                    }
+                    catch (...) {
+                    }
+                }
+            }
+        }
 
-        RawMemory<T> new_data(size_ == 0 ? 1 : size_ * 2);
+        /**
+         * @brief Computes the capacity to grow to with the growth policy.
+         * @param required The minimum capacity needed.
+         * @return The new capacity.
+         */
+        size_t NextCapacity(size_t required) const noexcept {
+            return Growth::NextCapacity(data_.Capacity(), required, sizeof(T));
+        }
+
+        /**
+         * @brief Destroys the elements and installs an adopted memory block holding size live elements.
+         * @param block The adopted block, receives the previous one.
+         * @param size The number of live elements in the block.
+         */
+        void AdoptBlock(RawMemory<T, Alloc>& block, size_t size) noexcept {
+            detail::DestroyN(data_.GetAllocator(), data_.GetAddress(), size_);
+            size_ = 0;
+            data_.Swap(block);
+            size_ = size;
+        }
 
-        new (new_data.GetAddress() + size_) T(std::forward<Type>(value));
+        /**
+         * @brief Relocates the elements into a new memory block leaving uninitialized slots at index.
+         * The source elements are destroyed on success and left intact if an exception is thrown.
+         * @param dst The address of the new memory block.
+         * @param index The position of the slots, Size() leaves them past the last element.
+         * @param gap The number of slots.
+         */
+        void RelocateWithGap(T* dst, size_t index, size_t gap = 1) {
+            T* src = data_.GetAddress();
 
-        if constexpr (std::is_nothrow_move_constructible_v<T> || !std::is_copy_constructible_v<T>) {
-            std::uninitialized_move_n(data_.GetAddress(), size_, new_data.GetAddress());
+            if constexpr (detail::kRelocatesBitwise<Alloc, T>) {
+                detail::UninitializedRelocateN(data_.GetAllocator(), src, index, dst);
+                detail::UninitializedRelocateN(data_.GetAllocator(), src + index, size_ - index, dst + index + gap);
+            }
+            else {
+                detail::UninitializedMoveIfNoexceptN(data_.GetAllocator(), src, index, dst);
+                try {
+                    detail::UninitializedMoveIfNoexceptN(data_.GetAllocator(), src + index, size_ - index, dst + index + gap);
+                }
+                catch (...) {
+                    detail::DestroyN(data_.GetAllocator(), dst, index);
+                    throw;
+                }
+                detail::DestroyN(data_.GetAllocator(), src, size_);
+            }
+            detail::RecordRelocation<T>(size_);
         }
-        else {
-            std::uninitialized_copy_n(data_.GetAddress(), size_, new_data.GetAddress());
+
+        /**
+         * @brief Grows the storage and emplaces a new element at the specified position.
+         * The element is constructed before the old elements are relocated, so args may refer to them.
+         * @param index The position of the new element.
+         * @param args The arguments to forward.
+         * @return A pointer to the emplaced element.
+         */
+        template <typename... Args>
+        T* EmplaceWithReallocation(size_t index, Args&&... args) {
+            const size_t new_capacity = NextCapacity(size_ + 1);
+
+            if constexpr (kGrowsInPlace) {
+                alignas(T) unsigned char storage[sizeof(T)];
+                T* item = reinterpret_cast<T*>(storage);
+
+                detail::ConstructAt(data_.GetAllocator(), item, std::forward<Args>(args)...);
+                try {
+                    data_.Reallocate(new_capacity, size_);
+                }
+                catch (...) {
+                    detail::DestroyAt(data_.GetAllocator(), item);
+                    throw;
+                }
+
+                T* slot = data_.GetAddress() + index;
+                std::memmove(static_cast<void*>(slot + 1), static_cast<const void*>(slot), (size_ - index) * sizeof(T));
+                std::memcpy(static_cast<void*>(slot), static_cast<const void*>(item), sizeof(T));
+                ++size_;
+                return slot;
+            }
+
+            RawMemory<T, Alloc> new_data(new_capacity, data_.GetAllocator());
+            T* slot = new_data.GetAddress() + index;
+
+            detail::ConstructAt(new_data.GetAllocator(), slot, std::forward<Args>(args)...);
+            try {
+                RelocateWithGap(new_data.GetAddress(), index);
+            }
+            catch (...) {
+                detail::DestroyAt(new_data.GetAllocator(), slot);
+                throw;
+            }
+
+            data_.Swap(new_data);
+            ++size_;
+            return slot;
         }
 
-        std::destroy_n(data_.GetAddress(), size_);
-        data_.Swap(new_data);
+        /**
+         * @brief Inserts count elements of a range at the specified position.
+         * Reallocates at most once and shifts the tail once. The range must not refer to the own elements.
+         * Gives the strong guarantee when reallocating or for bitwise relocatable elements, the basic one otherwise.
+         * @param index The position at which to insert the elements.
+         * @param first The iterator to the first source element.
+         * @param count The number of source elements.
+         * @return An iterator pointing to the first inserted element.
+         */
+        template <typename ForwardIt>
+        iterator InsertRange(size_t index, ForwardIt first, size_t count) {
+            if (size_ + count > data_.Capacity()) {
+                if constexpr (kGrowsInPlace) {
+                    data_.Reallocate(NextCapacity(size_ + count), size_);
+                }
+                else {
+                    RawMemory<T, Alloc> new_data(NextCapacity(size_ + count), data_.GetAllocator());
+                    T* slots = new_data.GetAddress() + index;
 
-    }
-    else {
-        new (data_.GetAddress() + size_) T(std::forward<Type>(value));
-    }
-    size_++;
+                    detail::UninitializedCopyN(new_data.GetAllocator(), first, count, slots);
+                    try {
+                        RelocateWithGap(new_data.GetAddress(), index, count);
+                    }
+                    catch (...) {
+                        detail::DestroyN(new_data.GetAllocator(), slots, count);
+                        throw;
+                    }
+
+                    data_.Swap(new_data);
+                    size_ += count;
+                    return slots;
+                }
+            }
+
+            T* slots = begin() + index;
+            const size_t tail = size_ - index;
+
+            if constexpr (detail::kRelocatesBitwise<Alloc, T>) {
+                std::memmove(static_cast<void*>(slots + count), static_cast<const void*>(slots), tail * sizeof(T));
+                try {
+                    detail::UninitializedCopyN(data_.GetAllocator(), first, count, slots);
+                }
+                catch (...) {
+                    std::memmove(static_cast<void*>(slots), static_cast<const void*>(slots + count), tail * sizeof(T));
+                    throw;
+                }
+                size_ += count;
+            }
+            else if (count >= tail) {
+                const ForwardIt mid = std::next(first, tail);
+                detail::UninitializedCopyN(data_.GetAllocator(), mid, count - tail, end());
+                try {
+                    detail::UninitializedCopyN(data_.GetAllocator(), std::make_move_iterator(slots), tail, end() + count - tail);
+                }
+                catch (...) {
+                    detail::DestroyN(data_.GetAllocator(), end(), count - tail);
+                    throw;
+                }
+                size_ += count;
+                std::copy_n(first, tail, slots);
+            }
+            else {
+                T* old_end = end();
+                detail::UninitializedCopyN(data_.GetAllocator(), std::make_move_iterator(old_end - count), count, old_end);
+                size_ += count;
+                std::move_backward(slots, old_end - count, old_end);
+                std::copy_n(first, count, slots);
+            }
+
+            return slots;
+        }
+
+        /*< The number of own elements before each new element of a merge. */
+        using MergePositions = Vector<size_t>;
+
+        /**
+         * @brief Finds where count sorted new elements go: the number of own elements before each of them.
+         * All the comparisons of a merge happen here, before anything is moved.
+         * @param first The forward iterator to the first new element.
+         * @param count The number of new elements.
+         * @param comp The ordering.
+         * @return The positions, in the order of the new elements.
+         */
+        template <typename ForwardIt, typename Compare>
+        MergePositions FindMergePositions(ForwardIt first, size_t count, Compare& comp) const {
+            MergePositions positions(count, DefaultInit);
+            const T* data = data_.GetAddress();
+            size_t position = 0;
+            for (size_t i = 0; i < count; ++i, ++first) {
+                position = std::upper_bound(data + position, data + size_, *first, comp) - data;
+                positions[i] = position;
+            }
+            return positions;
+        }
+
+        /**
+         * @brief Merges count sorted elements into the storage, which has room for them.
+         * Walks both sequences from the back: each run of own elements greater than the next new element
+         * is shifted up to its final place, then the new element is constructed below the run.
+         * Slots past the old size are constructed, the others are assigned, bitwise relocatable runs are memmoved.
+         * On an exception the elements constructed past the old size are destroyed and the size is kept.
+         * Bitwise relocated runs are moved back down first, so the Vector is left unchanged.
+         * @param last The bidirectional iterator past the last new element.
+         * @param count The number of new elements.
+         * @param positions The positions of the new elements found by FindMergePositions.
+         */
+        template <typename BidirIt>
+        void MergeInPlace(BidirIt last, size_t count, const MergePositions& positions) {
+            T* data = data_.GetAddress();
+            Alloc& alloc = data_.GetAllocator();
+            size_t remaining = size_;     // own elements [0, remaining) are not placed yet
+            size_t slot = size_ + count;  // slots [slot, size_ + count) hold their final values
+            size_t index = count;         // new elements [index, count) are placed
+
+            const auto put = [&](size_t target, auto&& value) {
+                if constexpr (detail::kRelocatesBitwise<Alloc, T>) {
+                    detail::ConstructAt(alloc, data + target, std::forward<decltype(value)>(value));
+                }
+                else if (target >= size_) {
+                    detail::ConstructAt(alloc, data + target, std::forward<decltype(value)>(value));
+                }
+                else {
+                    data[target] = std::forward<decltype(value)>(value);
+                }
+            };
+
+            try {
+                while (index != 0) {
+                    --last;
+                    const size_t run = positions[--index];
+                    const size_t run_size = remaining - run;
+                    if constexpr (detail::kRelocatesBitwise<Alloc, T>) {
+                        std::memmove(static_cast<void*>(data + slot - run_size), static_cast<const void*>(data + run), run_size * sizeof(T));
+                        slot -= run_size;
+                    }
+                    else {
+                        for (size_t src = remaining; src != run; --slot) {
+                            put(slot - 1, std::move(data[--src]));
+                        }
+                    }
+                    remaining = run;
+                    put(slot - 1, *last);
+                    --slot;
+                }
+            }
+            catch (...) {
+                if constexpr (detail::kRelocatesBitwise<Alloc, T>) {
+                    // From the bottom the slots hold the run of the failed element, then each placed element above its run
+                    for (size_t i = index; i < count; ++i) {
+                        if (i != index) {
+                            detail::DestroyAt(alloc, data + slot);
+                            ++slot;
+                        }
+                        const size_t run_size = (i + 1 < count ? positions[i + 1] : size_) - positions[i];
+                        std::memmove(static_cast<void*>(data + positions[i]), static_cast<const void*>(data + slot), run_size * sizeof(T));
+                        slot += run_size;
+                    }
+                }
+                else {
+                    const size_t constructed = std::max(slot, size_);
+                    detail::DestroyN(alloc, data + constructed, size_ + count - constructed);
+                }
+                throw;
+            }
+            size_ += count;
+        }
+
+        /**
+         * @brief Merges the own elements and count sorted new elements into a new memory block.
+         * Runs of own elements are relocated between the new ones, or copied if their move constructor can throw,
+         * in which case the source elements are kept until the merge succeeds. A move-only element whose
+         * constructor throws leaves the Vector empty.
+         * @param first The iterator to the first new element.
+         * @param count The number of new elements.
+         * @param positions The positions of the new elements found by FindMergePositions.
+         */
+        template <typename ForwardIt>
+        void MergeIntoNewBlock(ForwardIt first, size_t count, const MergePositions& positions) {
+            constexpr bool kRelocates = detail::kRelocatesBitwise<Alloc, T> || std::is_nothrow_move_constructible_v<T>
+                                        || !std::is_copy_constructible_v<T>;
+            RawMemory<T, Alloc> new_data(NextCapacity(size_ + count), data_.GetAllocator());
+            T* src = data_.GetAddress();
+            T* dst = new_data.GetAddress();
+            size_t placed = 0;  // own elements [0, placed) are transferred
+            size_t written = 0;
+
+            const auto transfer = [&](size_t n) {
+                if constexpr (kRelocates) {
+                    detail::UninitializedRelocateN(data_.GetAllocator(), src + placed, n, dst + written);
+                }
+                else {
+                    detail::UninitializedCopyN(data_.GetAllocator(), src + placed, n, dst + written);
+                }
+                placed += n;
+                written += n;
+            };
+
+            try {
+                for (size_t i = 0; i < count; ++i, ++first) {
+                    transfer(positions[i] - placed);
+                    detail::ConstructAt(new_data.GetAllocator(), dst + written, *first);
+                    ++written;
+                }
+                transfer(size_ - placed);
+            }
+            catch (...) {
+                detail::DestroyN(new_data.GetAllocator(), dst, written);
+                if constexpr (kRelocates) {
+                    // Only a move-only element with a throwing constructor gets here, the relocated elements are lost
+                    detail::DestroyN(data_.GetAllocator(), src + placed, size_ - placed);
+                    size_ = 0;
+                }
+                throw;
+            }
+
+            if constexpr (!kRelocates) {
+                detail::DestroyN(data_.GetAllocator(), src, size_);
+            }
+            detail::RecordRelocation<T>(size_);
+            data_.Swap(new_data);
+            size_ += count;
+        }
+
+        /**
+         * @brief Destroys the own elements and takes over the buffer of another Vector.
+         * @param other The other Vector object, left empty.
+         */
+        void StealFrom(Vector& other) noexcept(Storage::kNothrowTransfer) {
+            detail::DestroyN(data_.GetAllocator(), data_.GetAddress(), size_);
+            size_ = 0;
+            data_.TakeFrom(other.data_, other.size_);
+            size_ = std::exchange(other.size_, 0);
+        }
+
+        /**
+         * @brief Replaces the content with count elements of a range, reusing the storage when it is large enough.
+         * @param first The random access iterator to the first source element.
+         * @param count The number of source elements.
+         * @param policy The parallel policy, the calling thread only by default.
+         */
+        template <typename RandomIt>
+        void AssignFrom(RandomIt first, size_t count, ParallelTag policy = detail::kSingleThread) {
+            if (count <= data_.Capacity()) {
+                if (size_ <= count) {
+                    detail::ParallelCopyN(policy, first, size_, data_.GetAddress());
+
+                    detail::ParallelUninitializedCopyN(policy, data_.GetAllocator(), first + size_, count - size_, data_.GetAddress() + size_);
+                }
+                else {
+                    detail::ParallelCopyN(policy, first, count, data_.GetAddress());
+                    detail::DestroyN(data_.GetAllocator(), data_.GetAddress() + count, size_ - count);
+                }
+                size_ = count;
+            }
+            else {
+                RawMemory<T, Alloc> new_data(count, data_.GetAllocator());
+                detail::ParallelUninitializedCopyN(policy, new_data.GetAllocator(), first, count, new_data.GetAddress());
+                detail::DestroyN(data_.GetAllocator(), data_.GetAddress(), size_);
+                data_.Swap(new_data);
+                size_ = count;
+            }
+        }
+};
+
+/**
+ * @brief Pushes a new element to the end of the Vector.
+ * @tparam Type The type of the element to push.
+ * @param value The value of the element to push.
+ */
+template <typename T, typename Alloc, typename Growth, typename Storage>
+template <typename Type>
+void Vector<T, Alloc, Growth, Storage>::PushBack(Type&& value) {
+    EmplaceBack(std::forward<Type>(value));
 }
 
 /**
@@ -433,26 +2014,14 @@ void Vector<T>::PushBack(Type&& value) {
  * @param args The arguments to forward.
  * @return A reference to the emplaced element.
  */
-template <typename T>
+template <typename T, typename Alloc, typename Growth, typename Storage>
 template <typename... Args>
-T& Vector<T>::EmplaceBack(Args&&... args) {
+T& Vector<T, Alloc, Growth, Storage>::EmplaceBack(Args&&... args) {
     if (data_.Capacity() <= size_) {
-        RawMemory<T> new_data(size_ == 0 ? 1 : size_ * 2);
-        new (new_data.GetAddress() + size_) T(std::forward<Args>(args)...);
-        if constexpr (std::is_nothrow_move_constructible_v<T> || !std::is_copy_constructible_v<T>) {
-            std::uninitialized_move_n(data_.GetAddress(), size_, new_data.GetAddress());
-        }
-        else {
-            std::uninitialized_copy_n(data_.GetAddress(), size_, new_data.GetAddress());
-        }
-        std::destroy_n(data_.GetAddress(), size_);
-        data_.Swap(new_data);
-
-    }
-    else {
-        new (data_.GetAddress() + size_) T(std::forward<Args>(args)...);
+        return *EmplaceWithReallocation(size_, std::forward<Args>(args)...);
     }
 
+    detail::ConstructAt(data_.GetAllocator(), data_.GetAddress() + size_, std::forward<Args>(args)...);
     return data_[size_++];
 }
 
@@ -463,50 +2032,93 @@ T& Vector<T>::EmplaceBack(Args&&... args) {
  * @param args The arguments to forward.
  * @return An iterator pointing to the emplaced element.
  */
-template <typename T>
+template <typename T, typename Alloc, typename Growth, typename Storage>
 template <typename... Args>
-typename Vector<T>::iterator Vector<T>::Emplace(const_iterator pos, Args&&... args) {
+typename Vector<T, Alloc, Growth, Storage>::iterator Vector<T, Alloc, Growth, Storage>::Emplace(const_iterator pos, Args&&... args) {
     assert(pos >= begin() && pos <= end());
     size_t indx = pos - begin();
 
     if (data_.Capacity() <= size_) {
-
-        RawMemory<T> new_data(size_ == 0 ? 1 : size_ * 2);
-
-        new (new_data.GetAddress() + indx) T(std::forward<Args>(args)...);
-        if constexpr (std::is_nothrow_move_constructible_v<T> || !std::is_copy_constructible_v<T>) {
-            std::uninitialized_move_n(data_.GetAddress(), indx, new_data.GetAddress());
-            std::uninitialized_move_n(data_.GetAddress() + indx, size_ - indx, new_data.GetAddress() + indx + 1);
-        }
-        else {
-            std::uninitialized_copy_n(data_.GetAddress(), indx, new_data.GetAddress());
-            std::uninitialized_copy_n(data_.GetAddress() + indx, size_ - indx, new_data.GetAddress() + indx + 1);
-        }
-
-        std::destroy_n(data_.GetAddress(), size_);
-        data_.Swap(new_data);
+        return EmplaceWithReallocation(indx, std::forward<Args>(args)...);
     }
     else {
-        try {
-            if (pos != end()) {
+        if (pos != end()) {
 
-                T new_s(std::forward<Args>(args)...);
-                new (end()) T(std::forward<T>(data_[size_ - 1]));
+            T new_s(std::forward<Args>(args)...);
+            detail::ConstructAt(data_.GetAllocator(), end(), std::move(data_[size_ - 1]));
 
+            try {
                 std::move_backward(begin() + indx, end() - 1, end());
-                *(begin() + indx) = std::forward<T>(new_s);
-
+                *(begin() + indx) = std::move(new_s);
             }
-            else {
-                new (end()) T(std::forward<Args>(args)...);
+            catch (...) {
+                detail::DestroyAt(data_.GetAllocator(), end());
+                throw;
             }
-
         }
-        catch (...) {
-            operator delete (end());
-            throw;
+        else {
+            detail::ConstructAt(data_.GetAllocator(), end(), std::forward<Args>(args)...);
         }
     }
     size_++;
     return begin() + indx;
-}
\ No newline at end of file
+}
+
+/**
+ * @brief Compares two Vectors element by element, the allocators and storages may differ.
+ * Integers and enumerations are compared with a single memcmp.
+ * @param lhs The first Vector.
+ * @param rhs The second Vector.
+ * @return Whether both Vectors have the same size and equal elements.
+ */
+template <typename T, typename Alloc, typename Growth, typename Storage, typename OtherAlloc, typename OtherGrowth, typename OtherStorage>
+    requires std::equality_comparable<T>
+bool operator==(const Vector<T, Alloc, Growth, Storage>& lhs, const Vector<T, OtherAlloc, OtherGrowth, OtherStorage>& rhs) {
+    if (lhs.Size() != rhs.Size()) {
+        return false;
+    }
+    if constexpr (detail::kBitwiseComparable<T>) {
+        return lhs.Size() == 0 || std::memcmp(lhs.begin(), rhs.begin(), lhs.Size() * sizeof(T)) == 0;
+    }
+    else {
+        return std::equal(lhs.begin(), lhs.end(), rhs.begin());
+    }
+}
+
+/**
+ * @brief Compares two Vectors lexicographically. Single bytes are ordered by memcmp directly,
+ * other integers and enumerations skip the equal prefix with memcmp and compare only the first different elements.
+ * @param lhs The first Vector.
+ * @param rhs The second Vector.
+ * @return The ordering of the first different elements, or of the sizes if one Vector is a prefix of the other.
+ */
+template <typename T, typename Alloc, typename Growth, typename Storage, typename OtherAlloc, typename OtherGrowth, typename OtherStorage>
+    requires std::three_way_comparable<T>
+std::compare_three_way_result_t<T> operator<=>(const Vector<T, Alloc, Growth, Storage>& lhs, const Vector<T, OtherAlloc, OtherGrowth, OtherStorage>& rhs) {
+    const size_t common = std::min(lhs.Size(), rhs.Size());
+    if constexpr (detail::kBytewiseOrdered<T>) {
+        const int result = common == 0 ? 0 : std::memcmp(lhs.begin(), rhs.begin(), common);
+        return result != 0 ? result <=> 0 : lhs.Size() <=> rhs.Size();
+    }
+    else if constexpr (detail::kBitwiseComparable<T>) {
+        const size_t index = detail::MismatchIndex(lhs.begin(), rhs.begin(), common);
+        return index != common ? lhs[index] <=> rhs[index] : lhs.Size() <=> rhs.Size();
+    }
+    else {
+        return std::lexicographical_compare_three_way(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
+    }
+}
+
+/**
+ * @brief Erases all elements satisfying a predicate from the Vector in a single compacting pass.
+ * @param vector The Vector to erase from.
+ * @param pred The unary predicate returning true for the elements to erase.
+ * @return The number of erased elements.
+ */
+template <typename T, typename Alloc, typename Growth, typename Storage, typename Pred>
+size_t EraseIf(Vector<T, Alloc, Growth, Storage>& vector, Pred pred) {
+    const auto first = std::remove_if(vector.begin(), vector.end(), pred);
+    const size_t count = vector.end() - first;
+    vector.Erase(first, vector.end());
+    return count;
+}
@@ -0,0 +1,146 @@
+#pragma once
+
+/**
+ * @file vector_stats.h
+ * @brief Allocation and relocation counters for the Vector class.
+ * The counters are collected only when ADVANCED_VECTOR_STATS is defined before including vector.h,
+ * otherwise the hooks compile to nothing.
+ */
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <typeinfo>
+#include <vector>
+
+/**
+ * @brief The VectorStats class holds the counters of all Vector instances with one element type.
+ * All counters are updated with relaxed atomics and may be read at any time.
+ */
+struct VectorStats {
+    std::atomic<uint64_t> allocations{0};         /*< Memory blocks allocated. */
+    std::atomic<uint64_t> deallocations{0};       /*< Memory blocks released. */
+    std::atomic<uint64_t> reallocations{0};       /*< Times the elements were relocated to a new or resized block. */
+    std::atomic<uint64_t> relocated_bytes{0};     /*< Bytes of elements relocated, an upper bound for realloc growth. */
+    std::atomic<uint64_t> peak_capacity{0};       /*< The largest capacity of a single block, in elements. */
+    std::atomic<uint64_t> retired_vectors{0};     /*< Vectors destroyed. */
+    std::atomic<uint64_t> wasted_capacity{0};     /*< Sum of Capacity() - Size() over the destroyed Vectors, in elements. */
+
+    void Reset() noexcept {
+        allocations = 0;
+        deallocations = 0;
+        reallocations = 0;
+        relocated_bytes = 0;
+        peak_capacity = 0;
+        retired_vectors = 0;
+        wasted_capacity = 0;
+    }
+};
+
+/**
+ * @brief The VectorStatsRegistry class lists the VectorStats of every element type in use,
+ * so a metrics exporter can scrape them without knowing the types.
+ */
+class VectorStatsRegistry {
+    public:
+        static VectorStatsRegistry& Instance() {
+            static VectorStatsRegistry registry;
+            return registry;
+        }
+
+        /**
+         * @brief Registers the counters of an element type.
+         * @param type_name The name of the element type.
+         * @param stats The counters, must outlive the registry.
+         */
+        void Register(const char* type_name, VectorStats* stats) {
+            std::lock_guard lock(mutex_);
+            entries_.push_back({type_name, stats});
+        }
+
+        /**
+         * @brief Calls f(type_name, stats) for every registered element type.
+         * @param f The callback.
+         */
+        template <typename F>
+        void ForEach(F f) const {
+            std::lock_guard lock(mutex_);
+            for (const Entry& entry : entries_) {
+                f(entry.type_name, static_cast<const VectorStats&>(*entry.stats));
+            }
+        }
+
+        /**
+         * @brief Resets the counters of every registered element type.
+         */
+        void ResetAll() {
+            std::lock_guard lock(mutex_);
+            for (const Entry& entry : entries_) {
+                entry.stats->Reset();
+            }
+        }
+
+    private:
+        struct Entry {
+            const char* type_name;
+            VectorStats* stats;
+        };
+
+        mutable std::mutex mutex_;
+        std::vector<Entry> entries_;
+};
+
+/**
+ * @brief Gets the counters of Vectors with elements of type T, registering them on first use.
+ * @return A reference to the counters.
+ */
+template <typename T>
+VectorStats& VectorStatsFor() {
+    static VectorStats& stats = [] () -> VectorStats& {
+        static VectorStats instance;
+        VectorStatsRegistry::Instance().Register(typeid(T).name(), &instance);
+        return instance;
+    }();
+    return stats;
+}
+
+namespace detail {
+
+template <typename T>
+void RecordCapacity(size_t capacity) noexcept {
+    std::atomic<uint64_t>& peak_capacity = VectorStatsFor<T>().peak_capacity;
+    uint64_t peak = peak_capacity.load(std::memory_order_relaxed);
+    while (peak < capacity && !peak_capacity.compare_exchange_weak(peak, capacity, std::memory_order_relaxed)) {
+    }
+}
+
+template <typename T>
+void RecordAllocation(size_t capacity) noexcept {
+    VectorStatsFor<T>().allocations.fetch_add(1, std::memory_order_relaxed);
+    RecordCapacity<T>(capacity);
+}
+
+template <typename T>
+void RecordDeallocation() noexcept {
+    VectorStatsFor<T>().deallocations.fetch_add(1, std::memory_order_relaxed);
+}
+
+template <typename T>
+void RecordRelocation(size_t count) noexcept {
+    if (count == 0) {
+        return;
+    }
+    VectorStats& stats = VectorStatsFor<T>();
+    stats.reallocations.fetch_add(1, std::memory_order_relaxed);
+    stats.relocated_bytes.fetch_add(count * sizeof(T), std::memory_order_relaxed);
+}
+
+template <typename T>
+void RecordRetirement(size_t capacity, size_t size) noexcept {
+    VectorStats& stats = VectorStatsFor<T>();
+    stats.retired_vectors.fetch_add(1, std::memory_order_relaxed);
+    stats.wasted_capacity.fetch_add(capacity - size, std::memory_order_relaxed);
+}
+
+}  // namespace detail